@@ -0,0 +1,236 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// bakes a font into a c header when building, so the game doesn't have to
+// open one and draw every glyph at startup
+//
+// usage: blockgam-bakefont <font file> <output header> <size>...
+//
+// every size gets a glyph atlas of printable ascii laid out the same way
+// v_video.c lays out its own, kept as one bit a pixel since glyphs get
+// drawn solid anyway
+
+#define SDL_MAIN_HANDLED
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "s_alloc.h"
+#include "v_bakedfont.h"
+
+// same as the atlas in v_video.c
+#define ATLAS_COLUMNS (16)
+
+#define MAX_SIZES (32)
+
+static void Usage(void)
+{
+    fputs("usage: blockgam-bakefont <font file> <output header> <size>...\n", stderr);
+}
+
+// writes the atlas bits out as an array & fills in everything else about
+// the baked font, apart from the bits pointer
+static bool BakeSize(alloc_t* alloc, FILE* out, const char* fontPath, int size, bakedfont_t* baked)
+{
+    TTF_Font* font = TTF_OpenFont(fontPath, size);
+    if (!font)
+    {
+        fprintf(stderr, "Couldn't open %s at %d: %s\n", fontPath, size, TTF_GetError());
+        return false;
+    }
+
+    const SDL_Color white = { 255, 255, 255, 255 };
+
+    SDL_Surface* glyphSurfaces[BAKED_NUM_GLYPHS];
+    int cellWidth = 1;
+    int cellHeight = 1;
+
+    for (int i = 0; i < BAKED_NUM_GLYPHS; i++)
+    {
+        const uint16_t c = (uint16_t)(BAKED_FIRST_GLYPH + i);
+
+        int advance = 0;
+        TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &advance);
+        baked->glyphs[i] = (bakedglyph_t){ .advance = (int16_t)advance };
+
+        // spaces & missing glyphs don't draw anything
+        glyphSurfaces[i] = c == ' ' ? NULL : TTF_RenderGlyph_Solid(font, c, white);
+        if (glyphSurfaces[i])
+        {
+            cellWidth = SDL_max(cellWidth, glyphSurfaces[i]->w);
+            cellHeight = SDL_max(cellHeight, glyphSurfaces[i]->h);
+        }
+    }
+
+    const int rows = (BAKED_NUM_GLYPHS + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    baked->size = size;
+    baked->width = cellWidth * ATLAS_COLUMNS;
+    baked->height = cellHeight * rows;
+
+    const size_t numBytes = ((size_t)baked->width * baked->height + 7) / 8;
+    uint8_t* bits = S_Allocate(alloc, numBytes);
+
+    for (int i = 0; i < BAKED_NUM_GLYPHS; i++)
+    {
+        SDL_Surface* surface = glyphSurfaces[i];
+        if (!surface)
+        {
+            continue;
+        }
+
+        bakedglyph_t* glyph = &baked->glyphs[i];
+        glyph->x = (uint16_t)((i % ATLAS_COLUMNS) * cellWidth);
+        glyph->y = (uint16_t)((i / ATLAS_COLUMNS) * cellHeight);
+        glyph->w = (uint16_t)surface->w;
+        glyph->h = (uint16_t)surface->h;
+
+        // solid glyphs are 8 bit, 0 for the background & anything else
+        // for the glyph
+        SDL_LockSurface(surface);
+        for (int y = 0; bits && y < surface->h; y++)
+        {
+            const uint8_t* row = (const uint8_t*)surface->pixels + y * surface->pitch;
+            for (int x = 0; x < surface->w; x++)
+            {
+                if (row[x])
+                {
+                    const size_t bit = (size_t)(glyph->y + y) * baked->width + glyph->x + x;
+                    bits[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+                }
+            }
+        }
+        SDL_UnlockSurface(surface);
+
+        SDL_FreeSurface(surface);
+    }
+
+    TTF_CloseFont(font);
+
+    if (!bits)
+    {
+        fputs("Failed to allocate memory for glyph atlas\n", stderr);
+        return false;
+    }
+
+    fprintf(out, "static const uint8_t bakedBits%d[] = {", size);
+    for (size_t i = 0; i < numBytes; i++)
+    {
+        fprintf(out, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", bits[i]);
+    }
+    fputs("\n};\n\n", out);
+
+    S_Free(alloc, bits);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4 || argc - 3 > MAX_SIZES)
+    {
+        Usage();
+        return 1;
+    }
+
+    const char* fontPath = argv[1];
+    const char* outPath = argv[2];
+    const int numSizes = argc - 3;
+
+    int sizes[MAX_SIZES];
+    for (int i = 0; i < numSizes; i++)
+    {
+        sizes[i] = atoi(argv[i + 3]);
+        if (sizes[i] <= 0 || (i > 0 && sizes[i] <= sizes[i - 1]))
+        {
+            fputs("Sizes have to be positive & go from smallest to biggest\n", stderr);
+            return 1;
+        }
+    }
+
+    alloc_t* alloc = S_CreateAlloc();
+    if (!alloc)
+    {
+        fputs("Failed to initialize memory allocator\n", stderr);
+        return 1;
+    }
+
+    if (TTF_Init() == -1)
+    {
+        fputs("Failed to initialize SDL_ttf\n", stderr);
+        S_DestroyAlloc(alloc);
+        return 1;
+    }
+
+    FILE* out = fopen(outPath, "w");
+    if (!out)
+    {
+        fprintf(stderr, "Couldn't open %s for writing\n", outPath);
+        TTF_Quit();
+        S_DestroyAlloc(alloc);
+        return 1;
+    }
+
+    // v_bakedfont.h has to come first, the header doesn't include it
+    // itself since it ends up somewhere else when building
+    fputs("// made by blockgam-bakefont, don't edit\n\n", out);
+
+    bakedfont_t baked[MAX_SIZES];
+    bool ok = true;
+    for (int i = 0; ok && i < numSizes; i++)
+    {
+        ok = BakeSize(alloc, out, fontPath, sizes[i], &baked[i]);
+    }
+
+    if (ok)
+    {
+        fprintf(out, "#define NUM_BAKED_FONTS (%d)\n\n", numSizes);
+        fputs("// smallest to biggest\n", out);
+        fputs("static const bakedfont_t bakedFonts[NUM_BAKED_FONTS] = {\n", out);
+        for (int i = 0; i < numSizes; i++)
+        {
+            fprintf(out, "    {\n        .size = %d,\n        .width = %d,\n        .height = %d,\n        .bits = bakedBits%d,\n        .glyphs = {\n",
+                    baked[i].size, baked[i].width, baked[i].height, baked[i].size);
+            for (int j = 0; j < BAKED_NUM_GLYPHS; j++)
+            {
+                const bakedglyph_t* glyph = &baked[i].glyphs[j];
+                fprintf(out, "            { %d, %d, %d, %d, %d },\n", glyph->x, glyph->y, glyph->w, glyph->h, glyph->advance);
+            }
+            fputs("        },\n    },\n", out);
+        }
+        fputs("};\n", out);
+    }
+
+    if (fclose(out) != 0)
+    {
+        fprintf(stderr, "Failed to write %s\n", outPath);
+        ok = false;
+    }
+
+    // a half written header would only break the build later on
+    if (!ok)
+    {
+        remove(outPath);
+    }
+
+    TTF_Quit();
+    S_DestroyAlloc(alloc);
+
+    return ok ? 0 : 1;
+}
@@ -18,46 +18,103 @@
 #include "g_board.h"
 
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "SDL.h"
+
 #include "s_alloc.h"
 
 struct board_s
 {
     alloc_t* alloc;
-    uint8_t* grid;
+    uint8_t grid[GRID_WIDTH * GRID_HEIGHT];
+
+    uint32_t id;
+
+    uint64_t generation;
+    // the generation each row was last changed in
+    uint64_t rowGenerations[GRID_HEIGHT];
 };
 
 #define GRID_SIZE (GRID_WIDTH * GRID_HEIGHT * sizeof(uint8_t))
 
+// boards get made on more than one thread
+static SDL_atomic_t nextBoardId;
+
 board_t* G_CreateBoard(struct alloc_s* alloc)
 {
-    board_t* board = S_Allocate(alloc, sizeof(board_t));
+    return G_CreateBoards(alloc, 1);
+}
+
+void G_DestroyBoard(board_t* board)
+{
+    G_DestroyBoards(board);
+}
 
-    board->alloc = alloc;
+board_t* G_CreateBoards(struct alloc_s* alloc, int count)
+{
+    board_t* boards = S_Allocate(alloc, sizeof(board_t) * count);
+    if (!boards)
+    {
+        fputs("Failed to allocate memory for boards\n", stderr);
+        return NULL;
+    }
 
-    board->grid = S_Allocate(board->alloc, GRID_SIZE);
-    memset(board->grid, 0, GRID_SIZE);
+    for (int i = 0; i < count; i++)
+    {
+        boards[i].alloc = alloc;
+        memset(boards[i].grid, 0, GRID_SIZE);
 
-    return board;
+        boards[i].id = SDL_AtomicAdd(&nextBoardId, 1) + 1;
+    }
+
+    return boards;
 }
 
-void G_DestroyBoard(board_t* board)
+board_t* G_GetBoard(board_t* boards, int index)
 {
-    if (!board)
+    return &boards[index];
+}
+
+void G_DestroyBoards(board_t* boards)
+{
+    if (!boards)
     {
         return;
     }
 
-    S_Free(board->alloc, board->grid);
+    S_Free(boards->alloc, boards);
+}
 
-    S_Free(board->alloc, board);
+inline static void MarkRowsDirty(board_t* board, int from, int to)
+{
+    board->generation++;
+    for (int y = from; y < to; y++)
+    {
+        board->rowGenerations[y] = board->generation;
+    }
 }
 
 void G_ClearBoard(board_t* board)
 {
     memset(board->grid, 0, GRID_SIZE);
+    MarkRowsDirty(board, 0, GRID_HEIGHT);
+}
+
+void G_CopyBoard(board_t* dst, board_t* src)
+{
+    memcpy(dst->grid, src->grid, GRID_SIZE);
+
+    dst->id = src->id;
+    dst->generation = src->generation;
+    memcpy(dst->rowGenerations, src->rowGenerations, sizeof dst->rowGenerations);
+}
+
+uint32_t G_GetBoardId(board_t* board)
+{
+    return board->id;
 }
 
 uint8_t G_GetBoardSpace(board_t* board, int x, int y)
@@ -67,13 +124,17 @@ uint8_t G_GetBoardSpace(board_t* board, int x, int y)
 
 void G_SetBoardSpace(board_t* board, int x, int y, uint8_t val)
 {
+    if (board->grid[GRID_WIDTH * y + x] == val)
+    {
+        return;
+    }
+
     board->grid[GRID_WIDTH * y + x] = val;
+    MarkRowsDirty(board, y, y + 1);
 }
 
-bool G_TryBoardClear(board_t* board)
+int G_FindFullRow(board_t* board)
 {
-    int lineClear = -1;
-
     for (int j = 0; j < GRID_HEIGHT; j++)
     {
         bool validLine = true;
@@ -89,11 +150,17 @@ bool G_TryBoardClear(board_t* board)
 
         if (validLine)
         {
-            lineClear = j;
-            break;
+            return j;
         }
     }
 
+    return -1;
+}
+
+bool G_TryBoardClear(board_t* board)
+{
+    const int lineClear = G_FindFullRow(board);
+
     if (lineClear >= 0)
     {
         if (lineClear == 0)
@@ -109,8 +176,30 @@ bool G_TryBoardClear(board_t* board)
             memcpy(board->grid + (GRID_WIDTH * lineClear), board->grid + (GRID_WIDTH * (lineClear + 1)), sizeof(uint8_t) * (GRID_HEIGHT - lineClear - 1) * GRID_WIDTH);
         }
 
+        // everything above the line moved down
+        MarkRowsDirty(board, lineClear, GRID_HEIGHT);
+
         return true;
     }
 
     return false;
 }
+
+uint64_t G_GetBoardGeneration(board_t* board)
+{
+    return board->generation;
+}
+
+uint64_t G_GetBoardDirtyRows(board_t* board, uint64_t sinceGeneration)
+{
+    uint64_t rows = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++)
+    {
+        if (board->rowGenerations[y] > sinceGeneration)
+        {
+            rows |= UINT64_C(1) << y;
+        }
+    }
+
+    return rows;
+}
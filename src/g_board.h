@@ -24,6 +24,10 @@
 #define GRID_WIDTH (10)
 #define GRID_HEIGHT (30)
 
+// where new pieces appear on the board
+#define SPAWN_X (GRID_WIDTH / 2)
+#define SPAWN_Y (24)
+
 struct alloc_s;
 
 typedef struct board_s board_t;
@@ -32,12 +36,38 @@ board_t* G_CreateBoard(struct alloc_s* alloc);
 
 void G_DestroyBoard(board_t* board);
 
+// count boards side by side in one allocation, for keeping lots of boards
+// that get walked one after the other close together
+board_t* G_CreateBoards(struct alloc_s* alloc, int count);
+
+board_t* G_GetBoard(board_t* boards, int index);
+
+void G_DestroyBoards(board_t* boards);
+
 void G_ClearBoard(board_t* board);
 
+// copies keep the id of the board they came from
+void G_CopyBoard(board_t* dst, board_t* src);
+
+// different for every board made, so things that cache what a board looks
+// like can tell a copy of the same board from a different one
+uint32_t G_GetBoardId(board_t* board);
+
 uint8_t G_GetBoardSpace(board_t* board, int x, int y);
 
 void G_SetBoardSpace(board_t* board, int x, int y, uint8_t val);
 
+// lowest row with no gaps, or -1 if there isn't one, this is the row
+// G_TryBoardClear clears
+int G_FindFullRow(board_t* board);
+
 bool G_TryBoardClear(board_t* board);
 
+// goes up every time something on the board changes
+uint64_t G_GetBoardGeneration(board_t* board);
+
+// bit y is set if row y changed after the given generation
+// GRID_HEIGHT can't be more than 64 for this
+uint64_t G_GetBoardDirtyRows(board_t* board, uint64_t sinceGeneration);
+
 #endif  // TEBRIS_G_BOARD_H
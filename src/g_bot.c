@@ -0,0 +1,606 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "g_bot.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#include "g_board.h"
+#include "g_finesse.h"
+#include "g_ticktimer.h"
+#include "s_alloc.h"
+#include "s_queue.h"
+
+// how many pieces ahead the search can look
+// the first piece is known, every one after that is averaged over all types
+#define BOT_MAX_DEPTH (3)
+
+// only look at the clock every so often
+#define BOT_DEADLINE_CHECK (64)
+
+#define BOT_QUEUE_SIZE (4)
+
+typedef struct botrequest_s
+{
+    uint32_t id;
+    uint8_t grid[GRID_WIDTH * GRID_HEIGHT];
+    piecetype_t type;
+    int x;
+    int y;
+    // in SDL_GetTicks64 time, counted from when the piece spawned so time
+    // spent waiting for a worker comes out of it too
+    uint64_t deadline;
+} botrequest_t;
+
+typedef struct botresult_s
+{
+    uint32_t id;
+    int numKeys;
+    finessekey_t keys[FINESSE_MAX_KEYS];
+} botresult_t;
+
+typedef struct botworker_s
+{
+    struct botpool_s* pool;
+    SDL_Thread* thread;
+
+    // what it's searching for right now
+    bot_t* bot;
+    uint32_t id;
+    uint64_t deadline;
+    uint64_t nodes;
+    bool aborted;
+
+    board_t* boards[BOT_MAX_DEPTH + 1];
+    finesse_t* finesse[BOT_MAX_DEPTH + 1];
+} botworker_t;
+
+struct botpool_s
+{
+    alloc_t* alloc;
+
+    int numWorkers;
+    botworker_t* workers;
+
+    // posted once for every piece a bot gets asked about
+    SDL_sem* wake;
+    SDL_atomic_t quit;
+
+    // every bot made with the pool, newest first, only ever added to
+    void* bots;
+    SDL_atomic_t numBots;
+    // where the next worker starts looking, so no bot gets starved
+    SDL_atomic_t nextScan;
+};
+
+struct bot_s
+{
+    alloc_t* alloc;
+    botpool_t* pool;
+
+    // next one in the pool's list
+    bot_t* nextBot;
+
+    // newest piece, workers give up on anything older
+    SDL_atomic_t latestId;
+
+    // set by whichever worker is searching for this bot, only one at a
+    // time, so the queues only ever have one thread on each end
+    SDL_atomic_t busy;
+
+    // game -> worker
+    queue_t* requests;
+    // worker -> game
+    queue_t* results;
+
+    // only touched by the game thread
+    uint32_t currId;
+    bool hasPlan;
+    botresult_t plan;
+    int planKey;
+    // where the piece should be before the next key
+    int planY;
+};
+
+// rates how nice a board is to keep playing on, higher is better
+static double Evaluate(board_t* board)
+{
+    int heights[GRID_WIDTH];
+    int holes = 0;
+
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        heights[x] = 0;
+        for (int y = GRID_HEIGHT - 1; y >= 0; y--)
+        {
+            if (G_GetBoardSpace(board, x, y) != 0)
+            {
+                if (heights[x] == 0)
+                {
+                    heights[x] = y + 1;
+                }
+            }
+            else if (heights[x] != 0)
+            {
+                holes++;
+            }
+        }
+    }
+
+    int totalHeight = 0;
+    int bumpiness = 0;
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        totalHeight += heights[x];
+        if (x > 0)
+        {
+            bumpiness += abs(heights[x] - heights[x - 1]);
+        }
+    }
+
+    return -0.51 * totalHeight - 0.36 * holes - 0.18 * bumpiness;
+}
+
+// depth is how deep the search is going, the first depth always finishes
+// unless there's a newer piece, so there's always some plan
+static bool OutOfTime(botworker_t* worker, int depth)
+{
+    if (worker->aborted)
+    {
+        return true;
+    }
+
+    if ((++worker->nodes % BOT_DEADLINE_CHECK) == 0)
+    {
+        // give up early if the game already wants the next piece
+        if ((depth > 1 && SDL_GetTicks64() >= worker->deadline) ||
+            (uint32_t)SDL_AtomicGet(&worker->bot->latestId) != worker->id ||
+            SDL_AtomicGet(&worker->pool->quit))
+        {
+            worker->aborted = true;
+        }
+    }
+
+    return worker->aborted;
+}
+
+static double SearchUnknown(botworker_t* worker, int level, int depth, int totalDepth);
+
+// best placement of a known piece on worker->boards[level]
+static double SearchPiece(botworker_t* worker, int level, piecetype_t type, int x, int y, int depth, int totalDepth, int* bestPlacement)
+{
+    double best = -1e9;
+
+    // every place the piece can get to, using the same moves as a player
+    const int numPlacements = G_FinesseSweep(worker->finesse[level], worker->boards[level], type, x, y);
+
+    for (int p = 0; p < numPlacements; p++)
+    {
+        if (OutOfTime(worker, totalDepth))
+        {
+            return best;
+        }
+
+        board_t* next = worker->boards[level + 1];
+        G_CopyBoard(next, worker->boards[level]);
+        G_FinesseInsert(worker->finesse[level], p, next);
+
+        int lines = 0;
+        while (G_TryBoardClear(next))
+        {
+            lines++;
+        }
+
+        double value = 0.76 * lines;
+        if (depth > 1)
+        {
+            value += SearchUnknown(worker, level + 1, depth - 1, totalDepth);
+        }
+        else
+        {
+            value += Evaluate(next);
+        }
+
+        if (value > best)
+        {
+            best = value;
+            if (bestPlacement)
+            {
+                *bestPlacement = p;
+            }
+        }
+    }
+
+    return best;
+}
+
+// average over every piece that could come next
+static double SearchUnknown(botworker_t* worker, int level, int depth, int totalDepth)
+{
+    double total = 0.0;
+
+    for (int type = 0; type < PIECETYPE_END; type++)
+    {
+        total += SearchPiece(worker, level, type, SPAWN_X, SPAWN_Y, depth, totalDepth, NULL);
+        if (worker->aborted)
+        {
+            break;
+        }
+    }
+
+    return total / PIECETYPE_END;
+}
+
+static void Search(botworker_t* worker, bot_t* bot, const botrequest_t* request)
+{
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        for (int y = 0; y < GRID_HEIGHT; y++)
+        {
+            G_SetBoardSpace(worker->boards[0], x, y, request->grid[GRID_WIDTH * y + x]);
+        }
+    }
+
+    worker->bot = bot;
+    worker->id = request->id;
+    worker->deadline = request->deadline;
+    worker->nodes = 0;
+    worker->aborted = false;
+
+    int bestPlacement = -1;
+
+    // keep looking deeper until we run out of time
+    // only a fully finished depth counts
+    for (int depth = 1; depth <= BOT_MAX_DEPTH; depth++)
+    {
+        int placement = -1;
+        SearchPiece(worker, 0, request->type, request->x, request->y, depth, depth, &placement);
+
+        if (worker->aborted)
+        {
+            break;
+        }
+
+        bestPlacement = placement;
+    }
+
+    if (bestPlacement >= 0)
+    {
+        // only the first level ever sweeps the piece we're actually placing
+        botresult_t result;
+        result.id = request->id;
+        result.numKeys = G_FinesseGetKeys(worker->finesse[0], bestPlacement, result.keys);
+
+        // if the game is that far behind, the plan wouldn't be any use
+        S_QueuePush(bot->results, &result);
+    }
+}
+
+// claims the first bot with a piece waiting, starting somewhere different
+// every time, returns NULL if there's nothing to do
+static bot_t* ClaimBot(botpool_t* pool)
+{
+    const int numBots = SDL_AtomicGet(&pool->numBots);
+    if (numBots == 0)
+    {
+        return NULL;
+    }
+
+    bot_t* first = SDL_AtomicGetPtr(&pool->bots);
+    bot_t* bot = first;
+    for (int skip = SDL_AtomicAdd(&pool->nextScan, 1) % numBots; skip > 0 && bot->nextBot; skip--)
+    {
+        bot = bot->nextBot;
+    }
+
+    for (int i = 0; i < numBots && bot; i++)
+    {
+        if (S_QueueCount(bot->requests) > 0 && SDL_AtomicCAS(&bot->busy, 0, 1))
+        {
+            return bot;
+        }
+
+        bot = bot->nextBot ? bot->nextBot : first;
+    }
+
+    return NULL;
+}
+
+static int BotWorkerThread(void* data)
+{
+    botworker_t* worker = data;
+    botpool_t* pool = worker->pool;
+
+    while (true)
+    {
+        SDL_SemWait(pool->wake);
+
+        if (SDL_AtomicGet(&pool->quit))
+        {
+            break;
+        }
+
+        bot_t* bot = ClaimBot(pool);
+        if (!bot)
+        {
+            continue;
+        }
+
+        // only the newest piece is worth searching for
+        botrequest_t request;
+        bool haveRequest = false;
+        while (S_QueuePop(bot->requests, &request))
+        {
+            haveRequest = true;
+        }
+
+        if (haveRequest)
+        {
+            Search(worker, bot, &request);
+        }
+
+        SDL_AtomicSet(&bot->busy, 0);
+
+        // a worker woken for a piece that came in while this one was
+        // busy would have skipped the bot, so wake another for it
+        if (S_QueueCount(bot->requests) > 0)
+        {
+            SDL_SemPost(pool->wake);
+        }
+    }
+
+    return 0;
+}
+
+botpool_t* G_CreateBotPool(alloc_t* alloc, int numThreads)
+{
+    botpool_t* pool = S_Allocate(alloc, sizeof(botpool_t));
+    if (!pool)
+    {
+        fputs("Failed to allocate memory for bot pool\n", stderr);
+        return NULL;
+    }
+
+    pool->alloc = alloc;
+
+    SDL_AtomicSet(&pool->quit, 0);
+    pool->bots = NULL;
+    SDL_AtomicSet(&pool->numBots, 0);
+    SDL_AtomicSet(&pool->nextScan, 0);
+
+    if (!(pool->wake = SDL_CreateSemaphore(0)))
+    {
+        fprintf(stderr, "Failed to create bot pool semaphore: %s\n", SDL_GetError());
+        G_DestroyBotPool(pool);
+        return NULL;
+    }
+
+    if (numThreads <= 0)
+    {
+        numThreads = SDL_GetCPUCount();
+    }
+
+    pool->workers = S_Allocate(alloc, sizeof(botworker_t) * numThreads);
+    if (!pool->workers)
+    {
+        fputs("Failed to allocate memory for bot workers\n", stderr);
+        G_DestroyBotPool(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        botworker_t* worker = &pool->workers[i];
+        worker->pool = pool;
+
+        for (int j = 0; j <= BOT_MAX_DEPTH; j++)
+        {
+            worker->boards[j] = G_CreateBoard(alloc);
+            worker->finesse[j] = G_CreateFinesse(alloc);
+        }
+
+        // counted as it goes, so destroying only waits on threads that
+        // got made
+        pool->numWorkers++;
+
+        if (!(worker->thread = SDL_CreateThread(BotWorkerThread, "bot", worker)))
+        {
+            fprintf(stderr, "Failed to create bot thread: %s\n", SDL_GetError());
+            G_DestroyBotPool(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void G_DestroyBotPool(botpool_t* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    SDL_AtomicSet(&pool->quit, 1);
+    for (int i = 0; i < pool->numWorkers; i++)
+    {
+        SDL_SemPost(pool->wake);
+    }
+
+    for (int i = 0; i < pool->numWorkers; i++)
+    {
+        botworker_t* worker = &pool->workers[i];
+
+        if (worker->thread)
+            SDL_WaitThread(worker->thread, NULL);
+
+        for (int j = 0; j <= BOT_MAX_DEPTH; j++)
+        {
+            G_DestroyFinesse(worker->finesse[j]);
+            G_DestroyBoard(worker->boards[j]);
+        }
+    }
+
+    if (pool->workers)
+        S_Free(pool->alloc, pool->workers);
+
+    if (pool->wake)
+        SDL_DestroySemaphore(pool->wake);
+
+    S_Free(pool->alloc, pool);
+}
+
+bot_t* G_CreateBot(alloc_t* alloc, botpool_t* pool)
+{
+    bot_t* bot = S_Allocate(alloc, sizeof(bot_t));
+    if (!bot)
+    {
+        fputs("Failed to allocate memory for bot\n", stderr);
+        return NULL;
+    }
+
+    bot->alloc = alloc;
+    bot->pool = pool;
+
+    SDL_AtomicSet(&bot->latestId, 0);
+    SDL_AtomicSet(&bot->busy, 0);
+
+    bot->requests = S_CreateQueue(alloc, sizeof(botrequest_t), BOT_QUEUE_SIZE);
+    bot->results = S_CreateQueue(alloc, sizeof(botresult_t), BOT_QUEUE_SIZE);
+
+    bot->currId = 0;
+    bot->hasPlan = false;
+
+    if (!bot->requests || !bot->results)
+    {
+        fputs("Failed to create bot queues\n", stderr);
+        G_DestroyBot(bot);
+        return NULL;
+    }
+
+    // workers can already be walking the list, so the bot has to be all
+    // set up before it goes on
+    do
+    {
+        bot->nextBot = SDL_AtomicGetPtr(&pool->bots);
+    } while (!SDL_AtomicCASPtr(&pool->bots, bot->nextBot, bot));
+    SDL_AtomicAdd(&pool->numBots, 1);
+
+    return bot;
+}
+
+void G_DestroyBot(bot_t* bot)
+{
+    if (!bot)
+    {
+        return;
+    }
+
+    if (bot->requests)
+        S_DestroyQueue(bot->requests);
+
+    if (bot->results)
+        S_DestroyQueue(bot->results);
+
+    S_Free(bot->alloc, bot);
+}
+
+void G_BotPieceSpawned(bot_t* bot, board_t* board, piece_t* piece, uint64_t pieceDropSpeed)
+{
+    botrequest_t request;
+
+    request.id = ++bot->currId;
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        for (int y = 0; y < GRID_HEIGHT; y++)
+        {
+            request.grid[GRID_WIDTH * y + x] = G_GetBoardSpace(board, x, y);
+        }
+    }
+    request.type = G_GetPieceType(piece);
+    request.x = G_GetPieceX(piece);
+    request.y = G_GetPieceY(piece);
+
+    // take at most half the time it takes the piece to fall one space
+    // so the plan is ready before the piece goes anywhere
+    request.deadline = SDL_GetTicks64() + (pieceDropSpeed * 1000) / (TICK_RATE * 2);
+
+    bot->hasPlan = false;
+    bot->planY = request.y;
+
+    // a search still going for the last piece gives up when it sees this
+    SDL_AtomicSet(&bot->latestId, (int)request.id);
+
+    // if the bot is that far behind, just let the piece fall
+    if (S_QueuePush(bot->requests, &request))
+    {
+        SDL_SemPost(bot->pool->wake);
+    }
+}
+
+botaction_t G_BotNextAction(bot_t* bot, piece_t* piece)
+{
+    botresult_t result;
+    while (S_QueuePop(bot->results, &result))
+    {
+        // ignore answers for pieces that are already gone
+        if (result.id == bot->currId)
+        {
+            bot->hasPlan = true;
+            bot->plan = result;
+            bot->planKey = 0;
+        }
+    }
+
+    if (!bot->hasPlan)
+    {
+        return BOTACTION_NONE;
+    }
+
+    // gravity might have already done some of the drops for us
+    while (bot->planKey < bot->plan.numKeys &&
+           bot->plan.keys[bot->planKey] == FINESSEKEY_DROP &&
+           G_GetPieceY(piece) < bot->planY)
+    {
+        bot->planKey++;
+        bot->planY--;
+    }
+
+    if (bot->planKey >= bot->plan.numKeys)
+    {
+        return BOTACTION_NONE;
+    }
+
+    switch (bot->plan.keys[bot->planKey++])
+    {
+    case FINESSEKEY_LEFT:
+        return BOTACTION_LEFT;
+    case FINESSEKEY_RIGHT:
+        return BOTACTION_RIGHT;
+    case FINESSEKEY_ROTATE:
+        return BOTACTION_ROTATE;
+    case FINESSEKEY_DROP:
+        bot->planY--;
+        return BOTACTION_DROP;
+    }
+
+    return BOTACTION_NONE;
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_G_BOT_H
+#define TEBRIS_G_BOT_H
+
+#include <stdint.h>
+
+#include "g_piece.h"
+
+struct alloc_s;
+struct board_s;
+
+// bots search on a few threads shared by all of them, so lots of boards
+// don't mean lots of threads fighting over the cores
+typedef struct botpool_s botpool_t;
+
+// one bot per board a bot plays, the game talks to it through lock-free
+// queues so it never waits on a search or a worker
+typedef struct bot_s bot_t;
+
+typedef enum botaction_e
+{
+    BOTACTION_NONE,
+    BOTACTION_ROTATE,
+    BOTACTION_LEFT,
+    BOTACTION_RIGHT,
+    BOTACTION_DROP,
+} botaction_t;
+
+// numThreads of 0 or less uses one per core
+botpool_t* G_CreateBotPool(struct alloc_s* alloc, int numThreads);
+
+// every bot made with the pool has to be destroyed after it
+void G_DestroyBotPool(botpool_t* pool);
+
+bot_t* G_CreateBot(struct alloc_s* alloc, botpool_t* pool);
+
+void G_DestroyBot(bot_t* bot);
+
+// snapshot the board and start searching for where to put the new piece
+// the search gets a time budget based on how fast pieces are falling
+void G_BotPieceSpawned(bot_t* bot, struct board_s* board, piece_t* piece, uint64_t pieceDropSpeed);
+
+// the next input the bot wants to make for the piece, call once per tick
+botaction_t G_BotNextAction(bot_t* bot, piece_t* piece);
+
+#endif  // TEBRIS_G_BOT_H
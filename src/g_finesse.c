@@ -0,0 +1,392 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "g_finesse.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "g_board.h"
+#include "s_alloc.h"
+
+#define NUM_ROTATIONS (4)
+
+// every position the center of a piece can be in while its blocks are on the board
+#define MIN_X (-PIECE_WIDTH / 2)
+#define MAX_X (GRID_WIDTH + PIECE_WIDTH / 2)
+#define MIN_Y (-PIECE_HEIGHT / 2)
+#define MAX_Y (GRID_HEIGHT + PIECE_HEIGHT / 2)
+#define RANGE_X (MAX_X - MIN_X)
+#define RANGE_Y (MAX_Y - MIN_Y)
+
+#define NUM_STATES (NUM_ROTATIONS * RANGE_X * RANGE_Y)
+#define STATE(r, x, y) ((((r) * RANGE_X) + ((x) - MIN_X)) * RANGE_Y + ((y) - MIN_Y))
+#define STATE_R(s) ((s) / (RANGE_X * RANGE_Y))
+#define STATE_X(s) (((s) / RANGE_Y) % RANGE_X + MIN_X)
+#define STATE_Y(s) ((s) % RANGE_Y + MIN_Y)
+
+typedef struct shape_s
+{
+    int numRotations;
+    int cellX[NUM_ROTATIONS][PIECE_CELLS];
+    int cellY[NUM_ROTATIONS][PIECE_CELLS];
+    uint8_t color;
+} shape_t;
+
+struct finesse_s
+{
+    alloc_t* alloc;
+
+    shape_t shapes[PIECETYPE_END];
+
+    // the last sweep
+    piecetype_t type;
+
+    uint64_t visited[(NUM_STATES + 63) / 64];
+    uint16_t queue[NUM_STATES];
+    uint16_t parent[NUM_STATES];
+    uint8_t parentKey[NUM_STATES];
+
+    int numPlacements;
+    finesseplacement_t placements[NUM_STATES];
+    uint16_t placementStates[NUM_STATES];
+    uint64_t placementCells[NUM_STATES];
+};
+
+// figure out the shape of every rotation by actually rotating pieces
+// so this always matches the game
+static void BuildShapes(finesse_t* finesse)
+{
+    board_t* board = G_CreateBoard(finesse->alloc);
+    piece_t* piece = G_AllocatePiece(finesse->alloc);
+
+    for (int type = 0; type < PIECETYPE_END; type++)
+    {
+        shape_t* shape = &finesse->shapes[type];
+
+        G_CreatePiece(piece, type, GRID_WIDTH / 2, GRID_HEIGHT / 2);
+
+        shape->numRotations = 0;
+        for (int r = 0; r < NUM_ROTATIONS; r++)
+        {
+            if (r > 0 && !G_TryPieceRotate(piece, board))
+            {
+                break;
+            }
+
+            int cell = 0;
+            for (int i = -PIECE_WIDTH / 2; i <= PIECE_WIDTH / 2; i++)
+            {
+                for (int j = -PIECE_HEIGHT / 2; j <= PIECE_HEIGHT / 2; j++)
+                {
+                    const uint8_t c = G_GetPieceSpace(piece, i, j);
+                    if (!c || cell == PIECE_CELLS)
+                    {
+                        continue;
+                    }
+
+                    shape->color = c;
+                    shape->cellX[r][cell] = i;
+                    shape->cellY[r][cell] = j;
+                    cell++;
+                }
+            }
+
+            shape->numRotations++;
+        }
+    }
+
+    G_DestroyPiece(piece);
+    G_DestroyBoard(board);
+}
+
+finesse_t* G_CreateFinesse(alloc_t* alloc)
+{
+    finesse_t* finesse = S_Allocate(alloc, sizeof(finesse_t));
+    if (!finesse)
+    {
+        fputs("Failed to allocate memory for finesse\n", stderr);
+        return NULL;
+    }
+
+    finesse->alloc = alloc;
+    finesse->numPlacements = 0;
+
+    BuildShapes(finesse);
+
+    return finesse;
+}
+
+void G_DestroyFinesse(finesse_t* finesse)
+{
+    if (!finesse)
+    {
+        return;
+    }
+
+    S_Free(finesse->alloc, finesse);
+}
+
+// same rules as the game uses for moving pieces around
+inline static bool Fits(const shape_t* shape, board_t* board, int r, int x, int y)
+{
+    for (int i = 0; i < PIECE_CELLS; i++)
+    {
+        const int cx = x + shape->cellX[r][i];
+        const int cy = y + shape->cellY[r][i];
+
+        if (cy < 0 || cy >= GRID_HEIGHT || cx < 0 || cx >= GRID_WIDTH)
+        {
+            return false;
+        }
+
+        if (G_GetBoardSpace(board, cx, cy) > 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the blocks a piece covers, sorted so the same blocks give the same key
+static uint64_t CellsKey(const int* xs, const int* ys)
+{
+    uint16_t cells[PIECE_CELLS];
+    for (int i = 0; i < PIECE_CELLS; i++)
+    {
+        cells[i] = (uint16_t)(GRID_WIDTH * ys[i] + xs[i]);
+        for (int j = i; j > 0 && cells[j - 1] > cells[j]; j--)
+        {
+            const uint16_t tmp = cells[j];
+            cells[j] = cells[j - 1];
+            cells[j - 1] = tmp;
+        }
+    }
+
+    uint64_t key = 0;
+    for (int i = 0; i < PIECE_CELLS; i++)
+    {
+        key = (key << 16) | cells[i];
+    }
+
+    return key;
+}
+
+static uint64_t StateCellsKey(const shape_t* shape, int state)
+{
+    const int r = STATE_R(state);
+    const int x = STATE_X(state);
+    const int y = STATE_Y(state);
+
+    int xs[PIECE_CELLS];
+    int ys[PIECE_CELLS];
+    for (int i = 0; i < PIECE_CELLS; i++)
+    {
+        xs[i] = x + shape->cellX[r][i];
+        ys[i] = y + shape->cellY[r][i];
+    }
+
+    return CellsKey(xs, ys);
+}
+
+inline static bool TryVisit(finesse_t* finesse, int state, int from, finessekey_t key, int* queueEnd)
+{
+    uint64_t* word = &finesse->visited[state / 64];
+    const uint64_t bit = UINT64_C(1) << (state % 64);
+
+    if (*word & bit)
+    {
+        return false;
+    }
+
+    *word |= bit;
+    finesse->parent[state] = (uint16_t)from;
+    finesse->parentKey[state] = (uint8_t)key;
+    finesse->queue[(*queueEnd)++] = (uint16_t)state;
+
+    return true;
+}
+
+int G_FinesseSweep(finesse_t* finesse, board_t* board, piecetype_t type, int x, int y)
+{
+    const shape_t* shape = &finesse->shapes[type];
+
+    finesse->type = type;
+    finesse->numPlacements = 0;
+    memset(finesse->visited, 0, sizeof finesse->visited);
+
+    if (!Fits(shape, board, 0, x, y))
+    {
+        return 0;
+    }
+
+    int queueStart = 0;
+    int queueEnd = 0;
+
+    const int start = STATE(0, x, y);
+    TryVisit(finesse, start, start, FINESSEKEY_DROP, &queueEnd);
+
+    // breadth first, so every state is first reached with the fewest keys
+    while (queueStart < queueEnd)
+    {
+        const int state = finesse->queue[queueStart++];
+        const int r = STATE_R(state);
+        const int sx = STATE_X(state);
+        const int sy = STATE_Y(state);
+
+        if (Fits(shape, board, r, sx - 1, sy))
+        {
+            TryVisit(finesse, STATE(r, sx - 1, sy), state, FINESSEKEY_LEFT, &queueEnd);
+        }
+
+        if (Fits(shape, board, r, sx + 1, sy))
+        {
+            TryVisit(finesse, STATE(r, sx + 1, sy), state, FINESSEKEY_RIGHT, &queueEnd);
+        }
+
+        const int nextR = (r + 1) % shape->numRotations;
+        if (nextR != r && Fits(shape, board, nextR, sx, sy))
+        {
+            TryVisit(finesse, STATE(nextR, sx, sy), state, FINESSEKEY_ROTATE, &queueEnd);
+        }
+
+        if (Fits(shape, board, r, sx, sy - 1))
+        {
+            TryVisit(finesse, STATE(r, sx, sy - 1), state, FINESSEKEY_DROP, &queueEnd);
+            continue;
+        }
+
+        // can't drop any further, so the piece would lock here
+        // different rotations can cover the same blocks, keep the first
+        const uint64_t cells = StateCellsKey(shape, state);
+        bool seen = false;
+        for (int i = 0; i < finesse->numPlacements; i++)
+        {
+            if (finesse->placementCells[i] == cells)
+            {
+                seen = true;
+                break;
+            }
+        }
+
+        if (seen)
+        {
+            continue;
+        }
+
+        int numKeys = 0;
+        int numMoves = 0;
+        for (int s = state; s != start; s = finesse->parent[s])
+        {
+            numKeys++;
+            if (finesse->parentKey[s] != FINESSEKEY_DROP)
+            {
+                numMoves++;
+            }
+        }
+
+        const int p = finesse->numPlacements++;
+        finesse->placementCells[p] = cells;
+        finesse->placementStates[p] = (uint16_t)state;
+        finesse->placements[p] = (finesseplacement_t){
+            .x = sx,
+            .y = sy,
+            .rotations = r,
+            .numKeys = numKeys,
+            .numMoves = numMoves
+        };
+    }
+
+    return finesse->numPlacements;
+}
+
+const finesseplacement_t* G_FinesseGetPlacement(finesse_t* finesse, int placement)
+{
+    return &finesse->placements[placement];
+}
+
+int G_FinesseGetKeys(finesse_t* finesse, int placement, finessekey_t* keys)
+{
+    const finesseplacement_t* p = &finesse->placements[placement];
+    const int numKeys = p->numKeys < FINESSE_MAX_KEYS ? p->numKeys : FINESSE_MAX_KEYS;
+
+    // walk back from the end, skipping whatever doesn't fit in the buffer
+    int s = finesse->placementStates[placement];
+    for (int i = p->numKeys - 1; i >= 0; i--)
+    {
+        if (i < numKeys)
+        {
+            keys[i] = finesse->parentKey[s];
+        }
+        s = finesse->parent[s];
+    }
+
+    return numKeys;
+}
+
+void G_FinesseInsert(finesse_t* finesse, int placement, board_t* board)
+{
+    const shape_t* shape = &finesse->shapes[finesse->type];
+    const finesseplacement_t* p = &finesse->placements[placement];
+
+    for (int i = 0; i < PIECE_CELLS; i++)
+    {
+        G_SetBoardSpace(board, p->x + shape->cellX[p->rotations][i], p->y + shape->cellY[p->rotations][i], shape->color);
+    }
+}
+
+int G_FinesseFindPlacement(finesse_t* finesse, piece_t* piece)
+{
+    if (G_GetPieceType(piece) != finesse->type)
+    {
+        return -1;
+    }
+
+    int xs[PIECE_CELLS];
+    int ys[PIECE_CELLS];
+    int cell = 0;
+    for (int i = -PIECE_WIDTH / 2; i <= PIECE_WIDTH / 2; i++)
+    {
+        for (int j = -PIECE_HEIGHT / 2; j <= PIECE_HEIGHT / 2; j++)
+        {
+            if (G_GetPieceSpace(piece, i, j) && cell < PIECE_CELLS)
+            {
+                xs[cell] = G_GetPieceX(piece) + i;
+                ys[cell] = G_GetPieceY(piece) + j;
+                cell++;
+            }
+        }
+    }
+
+    if (cell != PIECE_CELLS)
+    {
+        return -1;
+    }
+
+    const uint64_t cells = CellsKey(xs, ys);
+    for (int i = 0; i < finesse->numPlacements; i++)
+    {
+        if (finesse->placementCells[i] == cells)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
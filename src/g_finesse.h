@@ -0,0 +1,73 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_G_FINESSE_H
+#define TEBRIS_G_FINESSE_H
+
+#include <stdint.h>
+
+#include "g_piece.h"
+
+struct alloc_s;
+struct board_s;
+
+// enough for dropping from the top of the board with every move on the way
+#define FINESSE_MAX_KEYS (64)
+
+// finds the fewest key presses to get a piece to every place it can land
+typedef struct finesse_s finesse_t;
+
+typedef enum finessekey_e
+{
+    FINESSEKEY_LEFT,
+    FINESSEKEY_RIGHT,
+    FINESSEKEY_ROTATE,
+    FINESSEKEY_DROP,
+} finessekey_t;
+
+typedef struct finesseplacement_s
+{
+    int x;
+    int y;
+    // times rotated from the spawn
+    int rotations;
+    // every key, including drops
+    int numKeys;
+    // only left, right and rotate, since gravity can do the drops
+    int numMoves;
+} finesseplacement_t;
+
+finesse_t* G_CreateFinesse(struct alloc_s* alloc);
+
+void G_DestroyFinesse(finesse_t* finesse);
+
+// search every place the piece can reach from (x, y) and land in
+// returns the number of placements found
+int G_FinesseSweep(finesse_t* finesse, struct board_s* board, piecetype_t type, int x, int y);
+
+const finesseplacement_t* G_FinesseGetPlacement(finesse_t* finesse, int placement);
+
+// fills keys with the presses to get to a placement, returns how many
+int G_FinesseGetKeys(finesse_t* finesse, int placement, finessekey_t* keys);
+
+// puts the blocks of a placement into the board
+void G_FinesseInsert(finesse_t* finesse, int placement, struct board_s* board);
+
+// which placement of the last sweep a piece is sitting in, -1 if none
+int G_FinesseFindPlacement(finesse_t* finesse, piece_t* piece);
+
+#endif  // TEBRIS_G_FINESSE_H
@@ -18,30 +18,82 @@
 #include "g_main.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "SDL.h"
 
 #include "g_board.h"
+#include "g_bot.h"
+#include "g_finesse.h"
 #include "g_piece.h"
 #include "g_ticktimer.h"
 #include "m_menu.h"
 #include "s_alloc.h"
+#include "s_queue.h"
+#include "s_triple.h"
 #include "v_video.h"
 
-struct game_s
+typedef enum hiddenpolicy_e
 {
-    alloc_t* alloc;
-
-    bool run;
+    // stop the game until the window comes back
+    HIDDENPOLICY_PAUSE,
+    // keep the game going in the background
+    HIDDENPOLICY_RUN,
+} hiddenpolicy_t;
+
+// input & menu choices, sent from the main thread to the game thread
+typedef enum gamecommand_e
+{
+    GAMECOMMAND_ROTATE,
+    GAMECOMMAND_LEFT,
+    GAMECOMMAND_RIGHT,
+    GAMECOMMAND_DROP,
+    GAMECOMMAND_START_GAME,
+    GAMECOMMAND_START_BOT_GAME,
+    GAMECOMMAND_PAUSE,
+    GAMECOMMAND_RESUME,
+} gamecommand_t;
+
+typedef struct command_s
+{
+    gamecommand_t type;
+    // when it happened, in SDL_GetTicks64 time, the game thread holds it
+    // back until the ticks before then have run
+    uint64_t time;
+} command_t;
 
-    gamestate_t state;
+#define COMMAND_QUEUE_SIZE (64)
 
-    video_t* video;
-
-    menu_t* menu;
+// things worth showing off, sent from the game thread to the main thread
+typedef enum effecttype_e
+{
+    EFFECTTYPE_LINE_CLEAR,
+    EFFECTTYPE_LANDING,
+} effecttype_t;
 
+typedef struct effect_s
+{
+    effecttype_t type;
+    int player;
+    // block in each column, 0 where there's nothing, & the row it's in
+    uint8_t cells[GRID_WIDTH];
+    int8_t rows[GRID_WIDTH];
+} effect_t;
+
+// effects are only for show, if the main thread falls behind they get
+// dropped
+#define EFFECT_QUEUE_SIZE (64)
+
+// BLOCKGAM_BOARDS can't go past this
+#define MAX_PLAYERS (64)
+
+// one board & whoever's playing it, the keyboard only ever plays the first
+typedef struct player_s
+{
+    // board & currPiece point into game_t's boards & pieces
     board_t* board;
 
     int level;
@@ -49,18 +101,134 @@ struct game_s
 
     bool pieceExists;
     piece_t* currPiece;
+    // ticks left until gravity moves the piece down
     uint64_t currPieceDrop;
 
-    ticktimer_t* timer;
+    // left, right & rotate presses on the current piece, from the keyboard
+    // or the bot
+    int pieceMoves;
+    // pieces placed with more presses than needed
+    int finesseFaults;
 
-    uint64_t lastTick;
+    // when set the bot plays instead of the keyboard
+    bool botPlaying;
+    // only made the first time a bot plays this board
+    bot_t* bot;
 
-    uint64_t failTimer;
+    // topped out, the board stays up but stops ticking
+    bool failed;
 
     // set to a value when a line is cleared
     // every tick, decrements
     // when 0, game continues
     uint64_t clearTimer;
+} player_t;
+
+// what gets drawn of each player
+typedef struct playerview_s
+{
+    board_t* board;
+
+    bool pieceExists;
+    piece_t* piece;
+    // how much of the way to the space below the piece has fallen as of
+    // the last tick, & how much more each tick adds, both 0 when it's
+    // resting on something so it gets drawn right where it'll lock
+    float fallProgress;
+    float fallRate;
+
+    bool failed;
+} playerview_t;
+
+// everything the main thread needs to draw a frame, copied out by the game
+// thread after it runs
+typedef struct snapshot_s
+{
+    gamestate_t state;
+
+    playerview_t* players;
+    // what the views point into
+    board_t* boards;
+    piece_t* pieces;
+    // when the next tick is due, for drawing the pieces in between ticks
+    uint64_t nextTickTime;
+
+    // the rest is for the first player
+    int level;
+    int finesseFaults;
+    bool botPlaying;
+    bool clearing;
+
+    bool paused;
+} snapshot_t;
+
+#define NUM_SNAPSHOTS (3)
+
+struct game_s
+{
+    alloc_t* alloc;
+
+    // everything up to the game thread's part is only for the main thread
+
+    bool run;
+
+    video_t* video;
+
+    menu_t* menu;
+
+    hiddenpolicy_t hiddenPolicy;
+    bool focusLost;
+    // what was last asked of the game thread
+    bool pauseRequested;
+
+    // newest snapshot from the game thread, what gets drawn
+    snapshot_t* view;
+
+    // the game thread wakes up for these as well as for ticks
+    queue_t* commands;
+    SDL_sem* simWake;
+    // commands never go back in time, so they stay in order in the queue
+    uint64_t lastCommandTime;
+
+    queue_t* effects;
+
+    snapshot_t snapshots[NUM_SNAPSHOTS];
+    triple_t* snapshotBuffer;
+
+    // sent to wake the main thread when the game changes by itself, like
+    // the fail screen running out
+    uint32_t wakeEvent;
+
+    SDL_Thread* simThread;
+    SDL_atomic_t simRunning;
+
+    // set once in G_Init, both threads read it
+    int numPlayers;
+
+    // everything from here is only for the game thread
+
+    gamestate_t state;
+
+    // all ticked in one go, one after the other
+    player_t* players;
+    // kept side by side for that, players[i] has boards[i] & pieces[i]
+    board_t* boards;
+    piece_t* pieces;
+
+    // threads the bots on every board share for searching
+    botpool_t* botPool;
+
+    // every place the first player's piece can go, for finesse feedback
+    finesse_t* finesse;
+
+    ticktimer_t* timer;
+
+    // timer is stopped because the window is hidden or out of focus
+    bool paused;
+
+    uint64_t lastTick;
+
+    uint64_t failTimer;
 };
 
 typedef struct gameitem_s
@@ -69,22 +237,128 @@ typedef struct gameitem_s
     game_t* game;
 } gameitem_t;
 
+// main thread only, time is when it happened in SDL_GetTicks64 time
+static void PushCommand(game_t* game, gamecommand_t type, uint64_t time)
+{
+    if (time < game->lastCommandTime)
+    {
+        time = game->lastCommandTime;
+    }
+    game->lastCommandTime = time;
+
+    const command_t command = { .type = type, .time = time };
+
+    // only happens if the game thread is stuck, a lost key press is the
+    // least of our worries then
+    if (!S_QueuePush(game->commands, &command))
+    {
+        fputs("Command queue full, dropping input\n", stderr);
+        return;
+    }
+
+    SDL_SemPost(game->simWake);
+}
+
 static void StartGame(menuitem_t* item)
 {
     gameitem_t* start = (gameitem_t*)item;
+    PushCommand(start->game, GAMECOMMAND_START_GAME, SDL_GetTicks64());
+}
 
-    G_ClearBoard(start->game->board);
-    start->game->state = GAMESTATE_PLAY;
+static void StartBotGame(menuitem_t* item)
+{
+    gameitem_t* start = (gameitem_t*)item;
+    PushCommand(start->game, GAMECOMMAND_START_BOT_GAME, SDL_GetTicks64());
+}
+
+// game thread only, the other boards always get bots
+static void BeginGame(game_t* game, bool bot)
+{
+    for (int i = 0; i < game->numPlayers; i++)
+    {
+        player_t* player = &game->players[i];
+
+        player->botPlaying = bot || i > 0;
 
-    start->game->level = 0;
-    start->game->pieceDropSpeed = 24;
+        if (player->botPlaying && !player->bot)
+        {
+            // nobody plays this board if the bot can't be made
+            if (!(player->bot = G_CreateBot(game->alloc, game->botPool)))
+            {
+                fputs("Failed to initialize bot\n", stderr);
+                player->botPlaying = false;
+            }
+        }
 
-    start->game->pieceExists = false;
-    start->game->currPieceDrop = 0;
+        G_ClearBoard(player->board);
 
-    start->game->lastTick = G_GetTimerTicks(start->game->timer);
+        player->level = 0;
+        player->pieceDropSpeed = 24;
 
-    start->game->clearTimer = 0;
+        player->pieceExists = false;
+        player->currPieceDrop = 0;
+
+        player->finesseFaults = 0;
+
+        player->failed = false;
+        player->clearTimer = 0;
+    }
+
+    game->state = GAMESTATE_PLAY;
+
+    game->lastTick = G_GetTimerTicks(game->timer);
+}
+
+// game thread only, apart from the first one in G_Init
+static void PublishSnapshot(game_t* game)
+{
+    snapshot_t* snapshot = &game->snapshots[S_TripleWriteIndex(game->snapshotBuffer)];
+
+    snapshot->state = game->state;
+
+    for (int i = 0; i < game->numPlayers; i++)
+    {
+        const player_t* player = &game->players[i];
+        playerview_t* view = &snapshot->players[i];
+
+        // copies keep the board's generations, so the board cache still
+        // only redraws rows that changed
+        G_CopyBoard(view->board, player->board);
+
+        view->pieceExists = player->pieceExists;
+
+        // try the drop on the copy, then put it back
+        G_CopyPiece(view->piece, player->currPiece);
+        const bool canFall = player->pieceExists && G_TryPieceDrop(view->piece, view->board);
+        G_CopyPiece(view->piece, player->currPiece);
+
+        // gravity moves the piece once every pieceDropSpeed + 1 ticks,
+        // any other drop starts the count over
+        view->fallProgress = 0.0f;
+        view->fallRate = 0.0f;
+        if (canFall)
+        {
+            const float interval = player->pieceDropSpeed + 1.0f;
+            const float done = (float)player->pieceDropSpeed - (float)player->currPieceDrop;
+
+            view->fallProgress = (done > 0.0f ? done : 0.0f) / interval;
+            view->fallRate = 1.0f / interval;
+        }
+
+        view->failed = player->failed;
+    }
+
+    snapshot->nextTickTime = G_GetTimerTickTime(game->timer, game->lastTick + 1);
+
+    const player_t* first = &game->players[0];
+    snapshot->level = first->level;
+    snapshot->finesseFaults = first->finesseFaults;
+    snapshot->botPlaying = first->botPlaying;
+    snapshot->clearing = first->clearTimer > 0;
+
+    snapshot->paused = game->paused;
+
+    S_TriplePublish(game->snapshotBuffer);
 }
 
 static void Settings(menuitem_t* item)
@@ -109,8 +383,8 @@ inline static bool CreateMenus(game_t* game)
 
     int32_t mainMenuId = M_AddList(game->menu, mainMenuList);
 
-    mainMenuList->items = S_Allocate(game->alloc, 3 * sizeof(menuitem_t*));
-    mainMenuList->numItems = 3;
+    mainMenuList->items = S_Allocate(game->alloc, 4 * sizeof(menuitem_t*));
+    mainMenuList->numItems = 4;
 
     gameitem_t* start = S_Allocate(game->alloc, sizeof(gameitem_t));
     mainMenuList->items[0] = &start->item;
@@ -118,14 +392,20 @@ inline static bool CreateMenus(game_t* game)
     start->item.label = "Start Game";
     start->game = game;
 
+    gameitem_t* bot = S_Allocate(game->alloc, sizeof(gameitem_t));
+    mainMenuList->items[1] = &bot->item;
+    bot->item.callback = StartBotGame;
+    bot->item.label = "Watch Bot";
+    bot->game = game;
+
     gameitem_t* settings = S_Allocate(game->alloc, sizeof(gameitem_t));
-    mainMenuList->items[1] = &settings->item;
+    mainMenuList->items[2] = &settings->item;
     settings->item.callback = Settings;
     settings->item.label = "Settings";
     settings->game = game;
 
     gameitem_t* quit = S_Allocate(game->alloc, sizeof(gameitem_t));
-    mainMenuList->items[2] = &quit->item;
+    mainMenuList->items[3] = &quit->item;
     quit->item.callback = Quit;
     quit->item.label = "Quit";
     quit->game = game;
@@ -166,19 +446,90 @@ game_t* G_Init(alloc_t* alloc)
         goto fail;
     }
 
-    if (!(game->board = G_CreateBoard(alloc)))
+    // BLOCKGAM_BOARDS=N plays N boards at once, the keyboard (or a bot)
+    // on the first & bots on the rest
+    game->numPlayers = 1;
+    const char* boards = SDL_getenv("BLOCKGAM_BOARDS");
+    if (boards)
+    {
+        game->numPlayers = SDL_atoi(boards);
+        if (game->numPlayers < 1 || game->numPlayers > MAX_PLAYERS)
+        {
+            fprintf(stderr, "Boards has to be from 1 to %d, using 1\n", MAX_PLAYERS);
+            game->numPlayers = 1;
+        }
+    }
+
+    if (!(game->players = S_Allocate(alloc, sizeof(player_t) * game->numPlayers)))
+    {
+        fputs("Failed to allocate memory for players\n", stderr);
+        goto fail;
+    }
+
+    if (!(game->boards = G_CreateBoards(alloc, game->numPlayers)) ||
+        !(game->pieces = G_AllocatePieces(alloc, game->numPlayers)))
     {
-        fputs("Failed to initialize board\n", stderr);
+        fputs("Failed to initialize boards\n", stderr);
         goto fail;
     }
 
-    game->pieceExists = false;
-    game->currPiece = G_AllocatePiece(game->alloc);
-    game->currPieceDrop = 0;
+    for (int i = 0; i < game->numPlayers; i++)
+    {
+        player_t* player = &game->players[i];
+
+        player->board = G_GetBoard(game->boards, i);
+
+        player->pieceExists = false;
+        player->currPiece = G_GetPiece(game->pieces, i);
+        player->currPieceDrop = 0;
+
+        player->botPlaying = false;
+        player->bot = NULL;
+    }
+
+    // leave a core for each of the main & game threads, more threads than
+    // boards would only ever sit idle
+    int botThreads = SDL_GetCPUCount() - 2;
+    if (botThreads < 1)
+        botThreads = 1;
+    if (botThreads > game->numPlayers)
+        botThreads = game->numPlayers;
+
+    if (!(game->botPool = G_CreateBotPool(alloc, botThreads)))
+    {
+        fputs("Failed to initialize bot pool\n", stderr);
+        goto fail;
+    }
+
+    V_SetBoardCount(game->video, game->numPlayers);
+
+    if (!(game->finesse = G_CreateFinesse(alloc)))
+    {
+        fputs("Failed to initialize finesse\n", stderr);
+        goto fail;
+    }
 
     game->timer = G_CreateTimer(alloc);
 
+    // BLOCKGAM_HIDDEN_POLICY=run keeps the game going while minimised,
+    // handy for leaving the bot to play
+    game->hiddenPolicy = HIDDENPOLICY_PAUSE;
+    const char* hiddenPolicy = SDL_getenv("BLOCKGAM_HIDDEN_POLICY");
+    if (hiddenPolicy && strcmp(hiddenPolicy, "run") == 0)
+    {
+        game->hiddenPolicy = HIDDENPOLICY_RUN;
+    }
+    else if (hiddenPolicy && strcmp(hiddenPolicy, "pause") != 0)
+    {
+        fprintf(stderr, "Unknown hidden policy %s, using pause\n", hiddenPolicy);
+    }
+
+    game->focusLost = false;
+    game->pauseRequested = false;
+    game->paused = false;
+
     game->lastTick = 0;
+    game->lastCommandTime = 0;
 
     if (!CreateMenus(game))
     {
@@ -186,6 +537,60 @@ game_t* G_Init(alloc_t* alloc)
         goto fail;
     }
 
+    if (!(game->commands = S_CreateQueue(alloc, sizeof(command_t), COMMAND_QUEUE_SIZE)))
+    {
+        fputs("Failed to create command queue\n", stderr);
+        goto fail;
+    }
+
+    if (!(game->effects = S_CreateQueue(alloc, sizeof(effect_t), EFFECT_QUEUE_SIZE)))
+    {
+        fputs("Failed to create effect queue\n", stderr);
+        goto fail;
+    }
+
+    if (!(game->simWake = SDL_CreateSemaphore(0)))
+    {
+        fputs("Failed to create game thread semaphore\n", stderr);
+        goto fail;
+    }
+
+    for (int i = 0; i < NUM_SNAPSHOTS; i++)
+    {
+        snapshot_t* snapshot = &game->snapshots[i];
+
+        if (!(snapshot->players = S_Allocate(alloc, sizeof(playerview_t) * game->numPlayers)))
+        {
+            fputs("Failed to allocate memory for snapshot\n", stderr);
+            goto fail;
+        }
+
+        if (!(snapshot->boards = G_CreateBoards(alloc, game->numPlayers)) ||
+            !(snapshot->pieces = G_AllocatePieces(alloc, game->numPlayers)))
+        {
+            fputs("Failed to create snapshot boards\n", stderr);
+            goto fail;
+        }
+
+        for (int j = 0; j < game->numPlayers; j++)
+        {
+            snapshot->players[j].board = G_GetBoard(snapshot->boards, j);
+            snapshot->players[j].piece = G_GetPiece(snapshot->pieces, j);
+        }
+    }
+
+    if (!(game->snapshotBuffer = S_CreateTriple(alloc)))
+    {
+        fputs("Failed to create snapshot buffer\n", stderr);
+        goto fail;
+    }
+
+    game->wakeEvent = SDL_RegisterEvents(1);
+
+    // so there's something to draw before the game thread gets going
+    PublishSnapshot(game);
+    game->view = &game->snapshots[S_TripleReadIndex(game->snapshotBuffer)];
+
     return game;
 
 fail:
@@ -195,11 +600,11 @@ fail:
     return NULL;
 }
 
-inline static bool TryDropPiece(game_t* game)
+inline static bool TryDropPiece(player_t* player)
 {
-    if (G_TryPieceDrop(game->currPiece, game->board))
+    if (G_TryPieceDrop(player->currPiece, player->board))
     {
-        game->currPieceDrop = game->pieceDropSpeed;
+        player->currPieceDrop = player->pieceDropSpeed;
 
         return true;
     }
@@ -207,6 +612,34 @@ inline static bool TryDropPiece(game_t* game)
     return false;
 }
 
+// with the pause policy, stop the game while the window is hidden, or
+// while someone is playing and clicks away
+inline static void UpdatePause(game_t* game)
+{
+    const bool hidden = !V_IsVisible(game->video);
+    const bool playing = game->view->state == GAMESTATE_PLAY && !game->view->botPlaying;
+    const bool pause = game->hiddenPolicy == HIDDENPOLICY_PAUSE && (hidden || (game->focusLost && playing));
+
+    if (pause == game->pauseRequested)
+    {
+        return;
+    }
+
+    PushCommand(game, pause ? GAMECOMMAND_PAUSE : GAMECOMMAND_RESUME, SDL_GetTicks64());
+    game->pauseRequested = pause;
+}
+
+// event timestamps are 32 bit SDL_GetTicks, this puts them back in
+// SDL_GetTicks64 time, they're never anywhere near 49 days old
+static uint64_t EventTime(uint32_t timestamp)
+{
+    const uint64_t now = SDL_GetTicks64();
+    const uint32_t age = (uint32_t)now - timestamp;
+
+    // from the future somehow, call it now
+    return age > now ? now : now - age;
+}
+
 inline static void ProcessEvents(game_t* game)
 {
     SDL_Event ev;
@@ -223,7 +656,7 @@ inline static void ProcessEvents(game_t* game)
                 game->run = false;
                 break;
             }
-            switch (game->state)
+            switch (game->view->state)
             {
             case GAMESTATE_MENU:
                 switch (ev.key.keysym.sym)
@@ -240,27 +673,46 @@ inline static void ProcessEvents(game_t* game)
                 }
                 break;
             case GAMESTATE_PLAY:
-                if (game->pieceExists)
+                // camera works for the bot too
+                switch (ev.key.keysym.sym)
                 {
-                    switch (ev.key.keysym.sym)
-                    {
-                    case SDLK_SPACE:
-                    case SDLK_UP:
-                        G_TryPieceRotate(game->currPiece, game->board);
-                        break;
-                    case SDLK_d:
-                    case SDLK_RIGHT:
-                        G_TryPieceRight(game->currPiece, game->board);
-                        break;
-                    case SDLK_a:
-                    case SDLK_LEFT:
-                        G_TryPieceLeft(game->currPiece, game->board);
-                        break;
-                    case SDLK_s:
-                    case SDLK_DOWN:
-                        TryDropPiece(game);
-                        break;
-                    }
+                case SDLK_EQUALS:
+                case SDLK_KP_PLUS:
+                    V_ZoomCamera(game->video, 1);
+                    break;
+                case SDLK_MINUS:
+                case SDLK_KP_MINUS:
+                    V_ZoomCamera(game->video, -1);
+                    break;
+                case SDLK_PAGEUP:
+                    V_PanCamera(game->video, 0, 2);
+                    break;
+                case SDLK_PAGEDOWN:
+                    V_PanCamera(game->video, 0, -2);
+                    break;
+                case SDLK_HOME:
+                    V_FollowPiece(game->video);
+                    break;
+                }
+
+                switch (ev.key.keysym.sym)
+                {
+                case SDLK_SPACE:
+                case SDLK_UP:
+                    PushCommand(game, GAMECOMMAND_ROTATE, EventTime(ev.key.timestamp));
+                    break;
+                case SDLK_d:
+                case SDLK_RIGHT:
+                    PushCommand(game, GAMECOMMAND_RIGHT, EventTime(ev.key.timestamp));
+                    break;
+                case SDLK_a:
+                case SDLK_LEFT:
+                    PushCommand(game, GAMECOMMAND_LEFT, EventTime(ev.key.timestamp));
+                    break;
+                case SDLK_s:
+                case SDLK_DOWN:
+                    PushCommand(game, GAMECOMMAND_DROP, EventTime(ev.key.timestamp));
+                    break;
                 }
                 break;
             }
@@ -271,126 +723,493 @@ inline static void ProcessEvents(game_t* game)
             case SDL_WINDOWEVENT_RESIZED:
                 V_WindowResized(game->video, ev.window.data1, ev.window.data2);
                 break;
+            case SDL_WINDOWEVENT_MINIMIZED:
+            case SDL_WINDOWEVENT_HIDDEN:
+                V_SetVisibility(game->video, false);
+                break;
+            case SDL_WINDOWEVENT_SHOWN:
+            case SDL_WINDOWEVENT_RESTORED:
+            case SDL_WINDOWEVENT_MAXIMIZED:
+            case SDL_WINDOWEVENT_EXPOSED:
+                V_SetVisibility(game->video, true);
+                break;
+            case SDL_WINDOWEVENT_FOCUS_LOST:
+                game->focusLost = true;
+                break;
+            case SDL_WINDOWEVENT_FOCUS_GAINED:
+                game->focusLost = false;
+                break;
             }
             break;
+        case SDL_RENDER_TARGETS_RESET:
+            V_RenderTargetsReset(game->video);
+            break;
+        }
+    }
+}
+
+// turn what the game thread sent into particles, or throw it away if
+// there's nothing to see
+inline static void SpawnEffects(game_t* game)
+{
+    const bool visible = V_IsVisible(game->video);
+
+    effect_t effect;
+    while (S_QueuePop(game->effects, &effect))
+    {
+        if (!visible)
+        {
+            continue;
+        }
+
+        switch (effect.type)
+        {
+        case EFFECTTYPE_LINE_CLEAR:
+            V_BurstRow(game->video, effect.player, effect.rows[0], effect.cells);
+            break;
+        case EFFECTTYPE_LANDING:
+            for (int x = 0; x < GRID_WIDTH; x++)
+            {
+                if (effect.cells[x])
+                {
+                    V_LandingDust(game->video, effect.player, x, effect.rows[x]);
+                }
+            }
+            break;
+        }
+    }
+}
+
+// how far along the current tick is, from 0 to 1
+inline static float TickFraction(const snapshot_t* view)
+{
+    // nothing's moving, so show where everything actually is
+    if (view->paused)
+    {
+        return 0.0f;
+    }
+
+    const uint64_t now = SDL_GetTicks64();
+    if (now >= view->nextTickTime)
+    {
+        return 1.0f;
+    }
+
+    const float fraction = 1.0f - (view->nextTickTime - now) * TICK_RATE / 1000.0f;
+    return fraction < 0.0f ? 0.0f : fraction;
+}
+
+inline static void DrawPlayers(game_t* game)
+{
+    const snapshot_t* view = game->view;
+    const float fraction = TickFraction(view);
+
+    if (game->numPlayers == 1)
+    {
+        const playerview_t* player = &view->players[0];
+
+        V_AimCamera(game->video, player->pieceExists ? player->piece : NULL);
+        V_DrawBoard(game->video, player->board);
+        if (player->pieceExists)
+        {
+            const float fall = -(player->fallProgress + player->fallRate * fraction);
+            V_DrawPiece(game->video, player->piece, fall);
         }
+        return;
+    }
+
+    // all of these go in the same batch
+    for (int i = 0; i < game->numPlayers; i++)
+    {
+        const playerview_t* player = &view->players[i];
+
+        float fall = 0.0f;
+        if (player->pieceExists)
+        {
+            fall = -(player->fallProgress + player->fallRate * fraction);
+        }
+
+        V_DrawBoardSlot(game->video, i, player->board, player->pieceExists ? player->piece : NULL, fall, player->failed);
     }
 }
 
 inline static void DrawScreen(game_t* game)
 {
+    const snapshot_t* view = game->view;
+
+    // nobody can see it anyway
+    if (!V_IsVisible(game->video))
+    {
+        return;
+    }
+
     // flash the screen when clearing
-    if (game->clearTimer > 0)
+    if (view->clearing)
 	V_Clear(game->video, 30, 30, 30);
     else
 	V_Clear(game->video, 0, 0, 0);
 
-    switch (game->state)
+    switch (view->state)
     {
     case GAMESTATE_MENU:
         V_DrawMenu(game->video, game->menu);
         break;
     case GAMESTATE_PLAY:
-        V_DrawBoard(game->video, game->board);
-        if (game->currPiece)
+        DrawPlayers(game);
+        V_DrawEffects(game->video);
+        V_DrawLevel(game->video, view->level);
+        if (!view->botPlaying)
         {
-            V_DrawPiece(game->video, game->currPiece);
+            V_DrawFinesse(game->video, view->finesseFaults);
         }
-        V_DrawLevel(game->video, game->level);
         break;
     case GAMESTATE_FAIL:
-        V_DrawFailure(game->video, game->level);
+        V_DrawFailure(game->video, view->level);
         break;
     }
 
+    if (view->paused)
+    {
+        V_DrawPaused(game->video);
+    }
+
     V_Present(game->video);
 }
 
-static bool ChooseRandomPiece(game_t* game)
+// keeps going every frame until loading's done, so no waiting for events
+inline static void DrawLoading(game_t* game)
 {
-    const int spawnX = GRID_WIDTH / 2;
-    const int spawnY = 24;
+    if (!V_IsVisible(game->video))
+    {
+        return;
+    }
 
-    if (G_GetBoardSpace(game->board, spawnX, spawnY) != 0)
+    V_Clear(game->video, 0, 0, 0);
+    V_DrawLoading(game->video);
+    V_Present(game->video);
+}
+
+static bool ChooseRandomPiece(game_t* game, player_t* player)
+{
+    if (G_GetBoardSpace(player->board, SPAWN_X, SPAWN_Y) != 0)
     {
         return false;
     }
 
     const int type = rand() % PIECETYPE_END;
-    game->currPieceDrop = game->pieceDropSpeed;
+    player->currPieceDrop = player->pieceDropSpeed;
+
+    G_CreatePiece(player->currPiece, type, SPAWN_X, SPAWN_Y);
+    player->pieceExists = true;
+
+    player->pieceMoves = 0;
 
-    G_CreatePiece(game->currPiece, type, spawnX, spawnY);
-    game->pieceExists = true;
+    if (player->botPlaying)
+    {
+        G_BotPieceSpawned(player->bot, player->board, player->currPiece, player->pieceDropSpeed);
+    }
+    else
+    {
+        G_FinesseSweep(game->finesse, player->board, type, SPAWN_X, SPAWN_Y);
+    }
 
     return true;
 }
 
-inline static void TryRunTicks(game_t* game)
+// count it against the player if they could have gotten the piece
+// to where it landed with fewer presses
+inline static void CheckFinesse(game_t* game, player_t* player)
 {
-    if (game->state == GAMESTATE_MENU)
+    const int placement = G_FinesseFindPlacement(game->finesse, player->currPiece);
+    if (placement < 0)
     {
         return;
     }
 
-    const uint64_t currTicks = G_GetTimerTicks(game->timer);
-    const uint64_t ticks = currTicks - game->lastTick;
-    game->lastTick = currTicks;
+    if (player->pieceMoves > G_FinesseGetPlacement(game->finesse, placement)->numMoves)
+    {
+        player->finesseFaults++;
+    }
+}
 
-    if (ticks == 0)
+// every input to a piece goes through here, whether it's from the keyboard
+// or the bot, so both move & get drawn exactly the same way
+static void MovePiece(player_t* player, finessekey_t key)
+{
+    switch (key)
     {
-        return;
+    case FINESSEKEY_ROTATE:
+        G_TryPieceRotate(player->currPiece, player->board);
+        player->pieceMoves++;
+        break;
+    case FINESSEKEY_LEFT:
+        G_TryPieceLeft(player->currPiece, player->board);
+        player->pieceMoves++;
+        break;
+    case FINESSEKEY_RIGHT:
+        G_TryPieceRight(player->currPiece, player->board);
+        player->pieceMoves++;
+        break;
+    case FINESSEKEY_DROP:
+        // restarts gravity, so the piece snaps to the new space
+        TryDropPiece(player);
+        break;
     }
+}
 
-    for (uint64_t i = 0; i < ticks; i++)
+// the bot gets one input per tick, before gravity like a key press
+inline static void RunBotAction(player_t* player)
+{
+    switch (G_BotNextAction(player->bot, player->currPiece))
     {
-        switch (game->state)
+    case BOTACTION_ROTATE:
+        MovePiece(player, FINESSEKEY_ROTATE);
+        break;
+    case BOTACTION_LEFT:
+        MovePiece(player, FINESSEKEY_LEFT);
+        break;
+    case BOTACTION_RIGHT:
+        MovePiece(player, FINESSEKEY_RIGHT);
+        break;
+    case BOTACTION_DROP:
+        MovePiece(player, FINESSEKEY_DROP);
+        break;
+    case BOTACTION_NONE:
+        break;
+    }
+}
+
+// the bottom block in each column of the piece, where it lands
+static void PushLanding(game_t* game, int index)
+{
+    const player_t* player = &game->players[index];
+    effect_t effect = { .type = EFFECTTYPE_LANDING, .player = index };
+
+    const int x = G_GetPieceX(player->currPiece);
+    const int y = G_GetPieceY(player->currPiece);
+
+    for (int i = -PIECE_WIDTH / 2; i <= PIECE_WIDTH / 2; i++)
+    {
+        if (x + i < 0 || x + i >= GRID_WIDTH)
         {
-        case GAMESTATE_PLAY:
-	    // wait a bit of time after a line clear to continue ticking
-            if (game->clearTimer > 0)
-            {
-		game->clearTimer -= 1;
-		continue;
-	    }
+            continue;
+        }
 
-            if (!game->pieceExists)
+        for (int j = -PIECE_HEIGHT / 2; j <= PIECE_HEIGHT / 2; j++)
+        {
+            const uint8_t c = G_GetPieceSpace(player->currPiece, i, j);
+            if (c)
             {
-                // if we can't fit a piece at the starting location,
-		// fail the player
-                if (!ChooseRandomPiece(game))
-                {
-                    game->state = GAMESTATE_FAIL;
-		    // wait for 4 sec on the fail screen
-                    game->failTimer = TICK_RATE * 4;
-                    continue;
-                }
+                effect.cells[x + i] = c;
+                effect.rows[x + i] = y + j;
+                break;
             }
+        }
+    }
+
+    S_QueuePush(game->effects, &effect);
+}
+
+static void PushLineClear(game_t* game, int index, int row)
+{
+    const player_t* player = &game->players[index];
+    effect_t effect = { .type = EFFECTTYPE_LINE_CLEAR, .player = index };
+
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        effect.cells[x] = G_GetBoardSpace(player->board, x, row);
+        effect.rows[x] = row;
+    }
+
+    S_QueuePush(game->effects, &effect);
+}
 
-            if (game->pieceExists)
+static void TickPlayer(game_t* game, int index)
+{
+    player_t* player = &game->players[index];
+
+    if (player->failed)
+    {
+        return;
+    }
+
+    // wait a bit of time after a line clear to continue ticking
+    if (player->clearTimer > 0)
+    {
+        player->clearTimer -= 1;
+        return;
+    }
+
+    if (!player->pieceExists)
+    {
+        // if we can't fit a piece at the starting location,
+        // fail the player
+        if (!ChooseRandomPiece(game, player))
+        {
+            player->failed = true;
+            return;
+        }
+    }
+
+    if (player->pieceExists)
+    {
+        if (player->botPlaying)
+        {
+            RunBotAction(player);
+        }
+
+        if (player->currPieceDrop-- == 0)
+        {
+            if (!TryDropPiece(player))
             {
-                if (game->currPieceDrop-- == 0)
+                if (!player->botPlaying)
                 {
-                    if (!TryDropPiece(game))
-                    {
-                        G_InsertPiece(game->currPiece, game->board);
-                        game->pieceExists = false;
-                    }
+                    CheckFinesse(game, player);
                 }
+
+                PushLanding(game, index);
+                G_InsertPiece(player->currPiece, player->board);
+                player->pieceExists = false;
             }
+        }
+    }
+
+    const int fullRow = G_FindFullRow(player->board);
+    if (fullRow >= 0)
+    {
+        PushLineClear(game, index, fullRow);
+    }
+
+    if (G_TryBoardClear(player->board))
+    {
+        player->level += 1;
+        // keep decreasing the drop time to make it harder
+        // as the game progresses
+        if (player->pieceDropSpeed > 8 &&
+            (player->level % 10) == 0)
+        {
+            player->pieceDropSpeed--;
+        }
+
+        // wait ~.1s for a line to clear
+        player->clearTimer = 0.1 * TICK_RATE;
+    }
+}
+
+// over once whoever's on the keyboard tops out, or with only bots, once
+// they all have
+static bool IsGameOver(game_t* game)
+{
+    const player_t* first = &game->players[0];
+    if (!first->botPlaying)
+    {
+        return first->failed;
+    }
 
-            if (G_TryBoardClear(game->board))
+    for (int i = 0; i < game->numPlayers; i++)
+    {
+        if (!game->players[i].failed)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void ApplyCommand(game_t* game, const command_t* command)
+{
+    switch (command->type)
+    {
+    case GAMECOMMAND_START_GAME:
+        BeginGame(game, false);
+        return;
+    case GAMECOMMAND_START_BOT_GAME:
+        BeginGame(game, true);
+        return;
+    case GAMECOMMAND_PAUSE:
+        G_PauseTimer(game->timer);
+        game->paused = true;
+        return;
+    case GAMECOMMAND_RESUME:
+        G_ResumeTimer(game->timer);
+        game->paused = false;
+        return;
+    default:
+        break;
+    }
+
+    // the rest move the first player's piece
+    player_t* player = &game->players[0];
+    if (game->state != GAMESTATE_PLAY || !player->pieceExists || player->botPlaying || game->paused)
+    {
+        return;
+    }
+
+    switch (command->type)
+    {
+    case GAMECOMMAND_ROTATE:
+        MovePiece(player, FINESSEKEY_ROTATE);
+        break;
+    case GAMECOMMAND_RIGHT:
+        MovePiece(player, FINESSEKEY_RIGHT);
+        break;
+    case GAMECOMMAND_LEFT:
+        MovePiece(player, FINESSEKEY_LEFT);
+        break;
+    case GAMECOMMAND_DROP:
+        MovePiece(player, FINESSEKEY_DROP);
+        break;
+    default:
+        break;
+    }
+}
+
+// everything from the main thread that happened before time, in order
+static void ApplyCommandsBefore(game_t* game, uint64_t time)
+{
+    command_t command;
+    while (S_QueuePeek(game->commands, &command) && command.time < time)
+    {
+        S_QueuePop(game->commands, &command);
+        ApplyCommand(game, &command);
+    }
+}
+
+// input that happened before a tick was due goes in right before it, so
+// it lands on the same tick however late the main thread got it to us,
+// even in the middle of catching up on a few ticks at once
+inline static void TryRunTicks(game_t* game)
+{
+    const uint64_t currTicks = G_GetTimerTicks(game->timer);
+
+    // pausing or going back to the menu partway stops the rest, pausing
+    // stops the timer too so they still get run after resuming
+    while (game->lastTick < currTicks && game->state != GAMESTATE_MENU && !game->paused)
+    {
+        const uint64_t tick = game->lastTick + 1;
+
+        ApplyCommandsBefore(game, G_GetTimerTickTime(game->timer, tick));
+        if (game->state == GAMESTATE_MENU || game->paused)
+        {
+            break;
+        }
+
+        game->lastTick = tick;
+
+        switch (game->state)
+        {
+        case GAMESTATE_PLAY:
+            for (int j = 0; j < game->numPlayers; j++)
             {
-                game->level += 1;
-                // keep decreasing the drop time to make it harder
-		// as the game progresses
-                if (game->pieceDropSpeed > 8 &&
-                    (game->level % 10) == 0)
-                {
-                    game->pieceDropSpeed--;
-                }
+                TickPlayer(game, j);
+            }
 
-		// wait ~.1s for a line to clear
-		game->clearTimer = 0.1 * TICK_RATE;
+            if (IsGameOver(game))
+            {
+                game->state = GAMESTATE_FAIL;
+                // wait for 4 sec on the fail screen
+                game->failTimer = TICK_RATE * 4;
             }
             break;
         case GAMESTATE_FAIL:
@@ -402,17 +1221,107 @@ inline static void TryRunTicks(game_t* game)
             break;
         }
     }
+
+    // anything left happened after the last tick
+    ApplyCommandsBefore(game, UINT64_MAX);
+}
+
+// ms until the game thread has something to do, not counting input, or
+// -1 if only input can change anything
+static int32_t TimeToNextTick(game_t* game)
+{
+    if (game->state == GAMESTATE_MENU || game->paused)
+    {
+        return -1;
+    }
+
+    const uint64_t now = SDL_GetTicks64();
+    const uint64_t next = G_GetTimerTickTime(game->timer, game->lastTick + 1);
+    return next > now ? (int32_t)(next - now) : 0;
+}
+
+// runs the game at the tick rate, taking input from the main thread and
+// handing back snapshots to draw
+static int RunGameThread(void* data)
+{
+    game_t* game = data;
+
+    while (SDL_AtomicGet(&game->simRunning))
+    {
+        const gamestate_t lastState = game->state;
+        const bool lastPaused = game->paused;
+
+        TryRunTicks(game);
+        PublishSnapshot(game);
+
+        // the main thread might be asleep on an idle screen
+        if ((game->state != lastState || game->paused != lastPaused) && game->wakeEvent != (uint32_t)-1)
+        {
+            SDL_Event ev = { .type = game->wakeEvent };
+            SDL_PushEvent(&ev);
+        }
+
+        const int32_t timeout = TimeToNextTick(game);
+        if (timeout < 0)
+            SDL_SemWait(game->simWake);
+        else if (timeout > 0)
+            SDL_SemWaitTimeout(game->simWake, timeout);
+    }
+
+    return 0;
+}
+
+// the menu & fail screens only change on input or when the game thread
+// says so, so sleep until one of those instead of drawing the same thing
+// over and over, same goes for when nothing can be seen
+// a resize waiting to settle wakes it up after timeout ms
+inline static void WaitWhileIdle(game_t* game, int timeout)
+{
+    if (game->view->paused || !V_IsVisible(game->video) || game->view->state != GAMESTATE_PLAY)
+    {
+        if (timeout >= 0)
+            SDL_WaitEventTimeout(NULL, timeout);
+        else
+            SDL_WaitEvent(NULL);
+    }
 }
 
 void G_RunGame(game_t* game)
 {
     game->run = true;
 
+    SDL_AtomicSet(&game->simRunning, 1);
+    if (!(game->simThread = SDL_CreateThread(RunGameThread, "game", game)))
+    {
+        fputs("Failed to start game thread\n", stderr);
+        game->run = false;
+    }
+
     while (game->run)
     {
-        TryRunTicks(game);
+        game->view = &game->snapshots[S_TripleReadIndex(game->snapshotBuffer)];
+
         ProcessEvents(game);
-        DrawScreen(game);
+        UpdatePause(game);
+        SpawnEffects(game);
+        const int resizeWait = V_SettleResize(game->video);
+        if (V_FinishLoading(game->video))
+        {
+            DrawScreen(game);
+            WaitWhileIdle(game, resizeWait);
+        }
+        else
+        {
+            DrawLoading(game);
+        }
+    }
+
+    if (game->simThread)
+    {
+        SDL_AtomicSet(&game->simRunning, 0);
+        SDL_SemPost(game->simWake);
+        SDL_WaitThread(game->simThread, NULL);
+        game->simThread = NULL;
     }
 
     game->run = false;
@@ -420,14 +1329,60 @@ void G_RunGame(game_t* game)
 
 void G_Quit(game_t* game)
 {
-    if (game->currPiece)
-        G_DestroyPiece(game->currPiece);
+    if (game->snapshotBuffer)
+        S_DestroyTriple(game->snapshotBuffer);
+
+    for (int i = 0; i < NUM_SNAPSHOTS; i++)
+    {
+        snapshot_t* snapshot = &game->snapshots[i];
+
+        if (snapshot->pieces)
+            G_DestroyPieces(snapshot->pieces);
+
+        if (snapshot->boards)
+            G_DestroyBoards(snapshot->boards);
+
+        if (snapshot->players)
+            S_Free(game->alloc, snapshot->players);
+    }
+
+    if (game->simWake)
+        SDL_DestroySemaphore(game->simWake);
+
+    if (game->effects)
+        S_DestroyQueue(game->effects);
+
+    if (game->commands)
+        S_DestroyQueue(game->commands);
 
     if (game->timer)
         G_DestroyTimer(game->timer);
 
-    if (game->board)
-        G_DestroyBoard(game->board);
+    if (game->finesse)
+        G_DestroyFinesse(game->finesse);
+
+    // the workers might still be looking at the bots
+    if (game->botPool)
+        G_DestroyBotPool(game->botPool);
+
+    if (game->players)
+    {
+        for (int i = 0; i < game->numPlayers; i++)
+        {
+            player_t* player = &game->players[i];
+
+            if (player->bot)
+                G_DestroyBot(player->bot);
+        }
+
+        S_Free(game->alloc, game->players);
+    }
+
+    if (game->pieces)
+        G_DestroyPieces(game->pieces);
+
+    if (game->boards)
+        G_DestroyBoards(game->boards);
 
     if (game->menu)
         M_Quit(game->menu);
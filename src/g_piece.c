@@ -29,8 +29,8 @@ struct piece_s
 {
     alloc_t* alloc;
     piecetype_t type;
-    uint8_t* data;
-    uint8_t* oldData;
+    uint8_t data[PIECE_WIDTH * PIECE_HEIGHT];
+    uint8_t oldData[PIECE_WIDTH * PIECE_HEIGHT];
     int x;
     int y;
 };
@@ -56,13 +56,29 @@ inline static void SetPieceSpace(piece_t* piece, int x, int y, uint8_t val)
 
 piece_t* G_AllocatePiece(struct alloc_s* alloc)
 {
-    piece_t* piece = S_Allocate(alloc, sizeof(piece_t));
-    piece->alloc = alloc;
-    piece->data = S_Allocate(alloc, PIECE_SIZE);
+    return G_AllocatePieces(alloc, 1);
+}
+
+piece_t* G_AllocatePieces(struct alloc_s* alloc, int count)
+{
+    piece_t* pieces = S_Allocate(alloc, sizeof(piece_t) * count);
+    if (!pieces)
+    {
+        fputs("Failed to allocate memory for pieces\n", stderr);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        pieces[i].alloc = alloc;
+    }
 
-    piece->oldData = S_Allocate(alloc, PIECE_SIZE);
+    return pieces;
+}
 
-    return piece;
+piece_t* G_GetPiece(piece_t* pieces, int index)
+{
+    return &pieces[index];
 }
 
 void G_CreatePiece(piece_t* piece, piecetype_t type, int x, int y)
@@ -126,16 +142,25 @@ void G_CreatePiece(piece_t* piece, piecetype_t type, int x, int y)
 
 void G_DestroyPiece(piece_t* piece)
 {
-    if (!piece)
+    G_DestroyPieces(piece);
+}
+
+void G_DestroyPieces(piece_t* pieces)
+{
+    if (!pieces)
     {
         return;
     }
 
-    S_Free(piece->alloc, piece->oldData);
-
-    S_Free(piece->alloc, piece->data);
+    S_Free(pieces->alloc, pieces);
+}
 
-    S_Free(piece->alloc, piece);
+void G_CopyPiece(piece_t* dst, piece_t* src)
+{
+    dst->type = src->type;
+    memcpy(dst->data, src->data, PIECE_SIZE);
+    dst->x = src->x;
+    dst->y = src->y;
 }
 
 inline static bool IsRotatableType(piecetype_t type)
@@ -193,20 +218,26 @@ inline static bool CanPiece(piece_t* piece, int xoff, int yoff, board_t* board)
     return true;
 }
 
-void G_TryPieceLeft(piece_t* piece, board_t* board)
+bool G_TryPieceLeft(piece_t* piece, board_t* board)
 {
     if (CanPiece(piece, -1, 0, board))
     {
         piece->x -= 1;
+        return true;
     }
+
+    return false;
 }
 
-void G_TryPieceRight(piece_t* piece, board_t* board)
+bool G_TryPieceRight(piece_t* piece, board_t* board)
 {
     if (CanPiece(piece, 1, 0, board))
     {
         piece->x += 1;
+        return true;
     }
+
+    return false;
 }
 
 bool G_TryPieceDrop(piece_t* piece, board_t* board)
@@ -220,11 +251,11 @@ bool G_TryPieceDrop(piece_t* piece, board_t* board)
     return false;
 }
 
-void G_TryPieceRotate(piece_t* piece, board_t* board)
+bool G_TryPieceRotate(piece_t* piece, board_t* board)
 {
     if (!IsRotatableType(piece->type))
     {
-        return;
+        return false;
     }
 
     memcpy(piece->oldData, piece->data, PIECE_SIZE);
@@ -240,7 +271,10 @@ void G_TryPieceRotate(piece_t* piece, board_t* board)
     if (!CanPiece(piece, 0, 0, board))
     {
         memcpy(piece->data, piece->oldData, PIECE_SIZE);
+        return false;
     }
+
+    return true;
 }
 
 void G_InsertPiece(piece_t* piece, board_t* board)
@@ -265,6 +299,11 @@ uint8_t G_GetPieceSpace(piece_t* piece, int x, int y)
     return *GetLoc(piece->data, x, y);
 }
 
+piecetype_t G_GetPieceType(piece_t* piece)
+{
+    return piece->type;
+}
+
 int G_GetPieceX(piece_t* piece)
 {
     return piece->x;
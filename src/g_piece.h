@@ -27,6 +27,9 @@ struct alloc_s;
 #define PIECE_WIDTH (5)
 #define PIECE_HEIGHT (5)
 
+// every piece is made of this many blocks
+#define PIECE_CELLS (4)
+
 typedef struct piece_s piece_t;
 
 typedef enum piecetype_e
@@ -43,22 +46,33 @@ typedef enum piecetype_e
 
 piece_t* G_AllocatePiece(struct alloc_s* alloc);
 
+// count pieces side by side in one allocation, like G_CreateBoards
+piece_t* G_AllocatePieces(struct alloc_s* alloc, int count);
+
+piece_t* G_GetPiece(piece_t* pieces, int index);
+
+void G_DestroyPieces(piece_t* pieces);
+
 void G_CreatePiece(piece_t* piece, piecetype_t type, int x, int y);
 
 void G_DestroyPiece(piece_t* piece);
 
-void G_TryPieceLeft(piece_t* piece, struct board_s* board);
+void G_CopyPiece(piece_t* dst, piece_t* src);
+
+bool G_TryPieceLeft(piece_t* piece, struct board_s* board);
 
-void G_TryPieceRight(piece_t* piece, struct board_s* board);
+bool G_TryPieceRight(piece_t* piece, struct board_s* board);
 
 bool G_TryPieceDrop(piece_t* piece, struct board_s* board);
 
-void G_TryPieceRotate(piece_t* piece, struct board_s* board);
+bool G_TryPieceRotate(piece_t* piece, struct board_s* board);
 
 void G_InsertPiece(piece_t* piece, struct board_s* board);
 
 uint8_t G_GetPieceSpace(piece_t* piece, int x, int y);
 
+piecetype_t G_GetPieceType(piece_t* piece);
+
 int G_GetPieceX(piece_t* piece);
 
 int G_GetPieceY(piece_t* piece);
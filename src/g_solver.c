@@ -0,0 +1,632 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "g_solver.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "g_board.h"
+#include "s_alloc.h"
+
+// boards are stored as GRID_WIDTH bits per row, bottom row first
+#define ROW_MASK ((UINT64_C(1) << GRID_WIDTH) - 1)
+
+// each worker remembers this many boards that can't be cleared
+#define VISITED_SIZE (1 << 20)
+
+#define NUM_ROTATIONS (4)
+
+// a piece's rotation, column & lowest row, the lowest row can go one
+// past the top of the rows being cleared
+#define NUM_STATES (NUM_ROTATIONS * GRID_WIDTH * (SOLVER_MAX_ROWS + 1))
+#define STATE(r, x, y) ((((r) * GRID_WIDTH) + (x)) * (SOLVER_MAX_ROWS + 1) + (y))
+#define STATE_R(s) ((s) / (GRID_WIDTH * (SOLVER_MAX_ROWS + 1)))
+#define STATE_X(s) (((s) / (SOLVER_MAX_ROWS + 1)) % GRID_WIDTH)
+#define STATE_Y(s) ((s) % (SOLVER_MAX_ROWS + 1))
+
+typedef struct shape_s
+{
+    // cells of the piece with its lowest row at row 0 & its center in
+    // each column, 0 where it doesn't fit between the walls
+    uint64_t masks[GRID_WIDTH];
+    int height;
+    // how far the center of the piece is above its lowest row
+    int centerY;
+} shape_t;
+
+typedef struct move_s
+{
+    // the blocks the piece ends up covering
+    uint64_t cells;
+    solverplacement_t placement;
+} move_t;
+
+typedef struct solverworker_s
+{
+    struct solver_s* solver;
+    SDL_Thread* thread;
+
+    // boards that are known to not work, stored as key + 1 so 0 is empty
+    uint64_t* visited;
+
+    uint64_t nodes;
+
+    solverplacement_t path[SOLVER_MAX_PIECES];
+    // where each piece of the path could go
+    move_t moves[SOLVER_MAX_PIECES][NUM_STATES];
+} solverworker_t;
+
+struct solver_s
+{
+    alloc_t* alloc;
+
+    shape_t shapes[PIECETYPE_END][NUM_ROTATIONS];
+    int numRotations[PIECETYPE_END];
+
+    int numWorkers;
+    solverworker_t* workers;
+
+    // the current search
+    piecetype_t queue[SOLVER_MAX_PIECES];
+    int numPieces;
+    uint64_t startBoard;
+    int startHeight;
+    // where the first piece can go, split up between the workers
+    move_t roots[NUM_STATES];
+    int numRoots;
+
+    SDL_atomic_t nextRoot;
+    // index of the worker that found a solution + 1, 0 when none has
+    SDL_atomic_t solvedBy;
+};
+
+// figure out the shape of every rotation by actually rotating pieces
+// so this always matches the game
+static void BuildShapes(solver_t* solver)
+{
+    board_t* board = G_CreateBoard(solver->alloc);
+    piece_t* piece = G_AllocatePiece(solver->alloc);
+
+    for (int type = 0; type < PIECETYPE_END; type++)
+    {
+        solver->numRotations[type] = 0;
+
+        G_CreatePiece(piece, type, GRID_WIDTH / 2, GRID_HEIGHT / 2);
+
+        for (int r = 0; r < NUM_ROTATIONS; r++)
+        {
+            if (r > 0 && !G_TryPieceRotate(piece, board))
+            {
+                break;
+            }
+
+            int minX = PIECE_WIDTH;
+            int maxX = -PIECE_WIDTH;
+            int minY = PIECE_HEIGHT;
+            int maxY = -PIECE_HEIGHT;
+            for (int i = -PIECE_WIDTH / 2; i <= PIECE_WIDTH / 2; i++)
+            {
+                for (int j = -PIECE_HEIGHT / 2; j <= PIECE_HEIGHT / 2; j++)
+                {
+                    if (!G_GetPieceSpace(piece, i, j))
+                    {
+                        continue;
+                    }
+
+                    minX = i < minX ? i : minX;
+                    maxX = i > maxX ? i : maxX;
+                    minY = j < minY ? j : minY;
+                    maxY = j > maxY ? j : maxY;
+                }
+            }
+
+            shape_t* shape = &solver->shapes[type][r];
+            memset(shape->masks, 0, sizeof shape->masks);
+            shape->height = maxY - minY + 1;
+            shape->centerY = -minY;
+
+            for (int x = -minX; x < GRID_WIDTH - maxX; x++)
+            {
+                for (int i = minX; i <= maxX; i++)
+                {
+                    for (int j = minY; j <= maxY; j++)
+                    {
+                        if (G_GetPieceSpace(piece, i, j))
+                        {
+                            shape->masks[x] |= UINT64_C(1) << ((j - minY) * GRID_WIDTH + x + i);
+                        }
+                    }
+                }
+            }
+
+            solver->numRotations[type]++;
+        }
+    }
+
+    G_DestroyPiece(piece);
+    G_DestroyBoard(board);
+}
+
+static int CountCells(uint64_t board)
+{
+    int count = 0;
+    while (board)
+    {
+        board &= board - 1;
+        count++;
+    }
+
+    return count;
+}
+
+// removes full rows, which also makes equivalent boards compare equal
+static uint64_t ClearLines(uint64_t board, int* height)
+{
+    for (int row = 0; row < *height;)
+    {
+        if (((board >> (row * GRID_WIDTH)) & ROW_MASK) != ROW_MASK)
+        {
+            row++;
+            continue;
+        }
+
+        const uint64_t below = board & ((UINT64_C(1) << (row * GRID_WIDTH)) - 1);
+        const uint64_t above = (row + 1) * GRID_WIDTH < 64 ? board >> ((row + 1) * GRID_WIDTH) : 0;
+        board = below | (above << (row * GRID_WIDTH));
+        *height -= 1;
+    }
+
+    return board;
+}
+
+// whatever is above the rows being cleared is always empty, so blocks
+// that stick out above the board just get shifted off the end
+inline static bool Fits(const shape_t* shape, uint64_t board, int x, int y)
+{
+    return shape->masks[x] && !(board & (shape->masks[x] << (y * GRID_WIDTH)));
+}
+
+inline static void Visit(uint64_t* visited, uint16_t* queue, int* queueEnd, int state)
+{
+    const uint64_t bit = UINT64_C(1) << (state % 64);
+    if (visited[state / 64] & bit)
+    {
+        return;
+    }
+
+    visited[state / 64] |= bit;
+    queue[(*queueEnd)++] = (uint16_t)state;
+}
+
+// every distinct place a piece can lock under the height, with the same
+// moves the game has, so tucks & spins under overhangs are in there too
+// above the height the board is empty, so the piece can start from any
+// rotation & column right on top of it
+static int FindMoves(const solver_t* solver, piecetype_t type, uint64_t board, int height, move_t* moves)
+{
+    const int numRotations = solver->numRotations[type];
+
+    uint64_t visited[(NUM_STATES + 63) / 64] = { 0 };
+    uint16_t queue[NUM_STATES];
+    int queueStart = 0;
+    int queueEnd = 0;
+
+    for (int r = 0; r < numRotations; r++)
+    {
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            if (solver->shapes[type][r].masks[x])
+            {
+                Visit(visited, queue, &queueEnd, STATE(r, x, height));
+            }
+        }
+    }
+
+    int numMoves = 0;
+
+    while (queueStart < queueEnd)
+    {
+        const int state = queue[queueStart++];
+        const int r = STATE_R(state);
+        const int x = STATE_X(state);
+        const int y = STATE_Y(state);
+        const shape_t* shape = &solver->shapes[type][r];
+
+        if (x > 0 && Fits(shape, board, x - 1, y))
+        {
+            Visit(visited, queue, &queueEnd, STATE(r, x - 1, y));
+        }
+
+        if (x < GRID_WIDTH - 1 && Fits(shape, board, x + 1, y))
+        {
+            Visit(visited, queue, &queueEnd, STATE(r, x + 1, y));
+        }
+
+        // rotating keeps the center where it is
+        const int nextR = (r + 1) % numRotations;
+        if (nextR != r)
+        {
+            const shape_t* next = &solver->shapes[type][nextR];
+            const int nextY = y + shape->centerY - next->centerY;
+
+            // anything past the height is already covered by the starts
+            if (nextY >= 0 && nextY <= height && Fits(next, board, x, nextY))
+            {
+                Visit(visited, queue, &queueEnd, STATE(nextR, x, nextY));
+            }
+        }
+
+        if (y > 0 && Fits(shape, board, x, y - 1))
+        {
+            Visit(visited, queue, &queueEnd, STATE(r, x, y - 1));
+            continue;
+        }
+
+        // can't drop any further, so the piece would lock here
+        if (y + shape->height > height)
+        {
+            continue;
+        }
+
+        // different rotations can cover the same blocks, keep the first
+        const uint64_t cells = shape->masks[x] << (y * GRID_WIDTH);
+        bool seen = false;
+        for (int i = 0; i < numMoves; i++)
+        {
+            if (moves[i].cells == cells)
+            {
+                seen = true;
+                break;
+            }
+        }
+
+        if (seen)
+        {
+            continue;
+        }
+
+        moves[numMoves++] = (move_t){
+            .cells = cells,
+            .placement = {
+                .type = type,
+                .rotations = r,
+                .x = x,
+                .y = y + shape->centerY
+            }
+        };
+    }
+
+    return numMoves;
+}
+
+inline static uint64_t HashKey(uint64_t key)
+{
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= UINT64_C(0xbf58476d1ce4e5b9);
+    key ^= key >> 27;
+    key *= UINT64_C(0x94d049bb133111eb);
+    key ^= key >> 31;
+    return key;
+}
+
+inline static uint64_t StateKey(uint64_t board, int depth)
+{
+    // the board only uses the low SOLVER_MAX_ROWS * GRID_WIDTH bits
+    return ((board << 4) | (uint64_t)depth) + 1;
+}
+
+// how far to look for a free slot before giving up
+// a full table only makes the search slower
+#define VISITED_PROBES (32)
+
+static bool IsVisited(solverworker_t* worker, uint64_t key)
+{
+    const uint64_t hash = HashKey(key);
+    for (int probe = 0; probe < VISITED_PROBES; probe++)
+    {
+        const uint64_t entry = worker->visited[(hash + probe) & (VISITED_SIZE - 1)];
+        if (entry == key)
+        {
+            return true;
+        }
+        if (entry == 0)
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+static void SetVisited(solverworker_t* worker, uint64_t key)
+{
+    const uint64_t hash = HashKey(key);
+    for (int probe = 0; probe < VISITED_PROBES; probe++)
+    {
+        uint64_t* entry = &worker->visited[(hash + probe) & (VISITED_SIZE - 1)];
+        if (*entry == 0)
+        {
+            *entry = key;
+            return;
+        }
+    }
+}
+
+static bool Search(solverworker_t* worker, uint64_t board, int height, int depth)
+{
+    solver_t* solver = worker->solver;
+
+    if (depth == solver->numPieces)
+    {
+        return board == 0;
+    }
+
+    const uint64_t key = StateKey(board, depth);
+    if (IsVisited(worker, key))
+    {
+        return false;
+    }
+
+    worker->nodes++;
+
+    move_t* moves = worker->moves[depth];
+    const int numMoves = FindMoves(solver, solver->queue[depth], board, height, moves);
+
+    for (int m = 0; m < numMoves; m++)
+    {
+        int newHeight = height;
+        const uint64_t newBoard = ClearLines(board | moves[m].cells, &newHeight);
+
+        worker->path[depth] = moves[m].placement;
+
+        if (Search(worker, newBoard, newHeight, depth + 1))
+        {
+            return true;
+        }
+
+        // somebody else already found one
+        if (SDL_AtomicGet(&solver->solvedBy))
+        {
+            return false;
+        }
+    }
+
+    SetVisited(worker, key);
+    return false;
+}
+
+static int WorkerThread(void* data)
+{
+    solverworker_t* worker = data;
+    solver_t* solver = worker->solver;
+
+    // split up the placements of the first piece between the workers
+    for (;;)
+    {
+        const int root = SDL_AtomicAdd(&solver->nextRoot, 1);
+        if (root >= solver->numRoots || SDL_AtomicGet(&solver->solvedBy))
+        {
+            break;
+        }
+
+        // Search only counts the boards it places pieces on, so count the
+        // first placement here
+        worker->nodes++;
+
+        int height = solver->startHeight;
+        const uint64_t board = ClearLines(solver->startBoard | solver->roots[root].cells, &height);
+
+        worker->path[0] = solver->roots[root].placement;
+
+        if (Search(worker, board, height, 1))
+        {
+            SDL_AtomicCAS(&solver->solvedBy, 0, (int)(worker - solver->workers) + 1);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+solver_t* G_CreateSolver(alloc_t* alloc, int numThreads)
+{
+    solver_t* solver = S_Allocate(alloc, sizeof(solver_t));
+    if (!solver)
+    {
+        fputs("Failed to allocate memory for solver\n", stderr);
+        return NULL;
+    }
+
+    solver->alloc = alloc;
+
+    if (numThreads <= 0)
+    {
+        numThreads = SDL_GetCPUCount();
+    }
+    solver->numWorkers = numThreads;
+
+    solver->workers = S_Allocate(alloc, sizeof(solverworker_t) * numThreads);
+    if (!solver->workers)
+    {
+        fputs("Failed to allocate memory for solver workers\n", stderr);
+        G_DestroySolver(solver);
+        return NULL;
+    }
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        solver->workers[i].solver = solver;
+        solver->workers[i].visited = S_Allocate(alloc, sizeof(uint64_t) * VISITED_SIZE);
+        if (!solver->workers[i].visited)
+        {
+            fputs("Failed to allocate memory for solver visited table\n", stderr);
+            G_DestroySolver(solver);
+            return NULL;
+        }
+    }
+
+    BuildShapes(solver);
+
+    return solver;
+}
+
+void G_DestroySolver(solver_t* solver)
+{
+    if (!solver)
+    {
+        return;
+    }
+
+    if (solver->workers)
+    {
+        for (int i = 0; i < solver->numWorkers; i++)
+        {
+            if (solver->workers[i].visited)
+                S_Free(solver->alloc, solver->workers[i].visited);
+        }
+
+        S_Free(solver->alloc, solver->workers);
+    }
+
+    S_Free(solver->alloc, solver);
+}
+
+// search for a clear using exactly numPieces pieces
+static bool SearchPieces(solver_t* solver, int numPieces, solverresult_t* result)
+{
+    solver->numPieces = numPieces;
+    SDL_AtomicSet(&solver->nextRoot, 0);
+    SDL_AtomicSet(&solver->solvedBy, 0);
+
+    for (int i = 0; i < solver->numWorkers; i++)
+    {
+        solverworker_t* worker = &solver->workers[i];
+
+        memset(worker->visited, 0, sizeof(uint64_t) * VISITED_SIZE);
+        worker->nodes = 0;
+
+        if (!(worker->thread = SDL_CreateThread(WorkerThread, "solver", worker)))
+        {
+            // do it on this thread instead
+            WorkerThread(worker);
+        }
+    }
+
+    for (int i = 0; i < solver->numWorkers; i++)
+    {
+        solverworker_t* worker = &solver->workers[i];
+        if (worker->thread)
+        {
+            SDL_WaitThread(worker->thread, NULL);
+            worker->thread = NULL;
+        }
+
+        result->nodes += worker->nodes;
+    }
+
+    const int solvedBy = SDL_AtomicGet(&solver->solvedBy);
+    if (solvedBy)
+    {
+        result->solved = true;
+        result->numPlacements = numPieces;
+        memcpy(result->placements, solver->workers[solvedBy - 1].path, sizeof(solverplacement_t) * numPieces);
+        return true;
+    }
+
+    return false;
+}
+
+bool G_SolvePerfectClear(solver_t* solver, board_t* board, const piecetype_t* queue, int queueLength, int maxPieces, solverresult_t* result)
+{
+    memset(result, 0, sizeof(solverresult_t));
+
+    if (maxPieces > queueLength)
+    {
+        maxPieces = queueLength;
+    }
+
+    if (maxPieces > SOLVER_MAX_PIECES)
+    {
+        fprintf(stderr, "Can't search more than %d pieces\n", SOLVER_MAX_PIECES);
+        return false;
+    }
+
+    // pack the board into bits
+    uint64_t packed = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++)
+    {
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            if (!G_GetBoardSpace(board, x, y))
+            {
+                continue;
+            }
+
+            if (y >= SOLVER_MAX_ROWS)
+            {
+                fprintf(stderr, "Boards can't be more than %d rows high\n", SOLVER_MAX_ROWS);
+                return false;
+            }
+
+            packed |= UINT64_C(1) << (y * GRID_WIDTH + x);
+        }
+    }
+
+    int packedHeight = SOLVER_MAX_ROWS;
+    packed = ClearLines(packed, &packedHeight);
+
+    memcpy(solver->queue, queue, sizeof(piecetype_t) * maxPieces);
+    solver->startBoard = packed;
+
+    const int cells = CountCells(packed);
+    const uint64_t start = SDL_GetPerformanceCounter();
+
+    // every block placed has to end up in a cleared row, so the number of
+    // pieces decides exactly how many rows get cleared
+    // try the fewest pieces first
+    for (int numPieces = 1; numPieces <= maxPieces && !result->solved; numPieces++)
+    {
+        if ((cells + numPieces * PIECE_CELLS) % GRID_WIDTH != 0)
+        {
+            continue;
+        }
+
+        const int height = (cells + numPieces * PIECE_CELLS) / GRID_WIDTH;
+        if (height > SOLVER_MAX_ROWS)
+        {
+            break;
+        }
+
+        solver->startHeight = height;
+        if ((packed >> (height * GRID_WIDTH)) != 0)
+        {
+            continue;
+        }
+
+        solver->numRoots = FindMoves(solver, queue[0], packed, height, solver->roots);
+
+        SearchPieces(solver, numPieces, result);
+    }
+
+    result->time = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_G_SOLVER_H
+#define TEBRIS_G_SOLVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "g_piece.h"
+
+struct alloc_s;
+struct board_s;
+
+// the whole board has to fit in a 64 bit mask
+#define SOLVER_MAX_ROWS (6)
+#define SOLVER_MAX_PIECES (15)
+
+// searches for perfect clears, an exhaustive depth first search over
+// every place a piece can be moved into and lock, not just hard drops
+typedef struct solver_s solver_t;
+
+typedef struct solverplacement_s
+{
+    piecetype_t type;
+    // times the piece gets rotated after spawning
+    int rotations;
+    // where the center of the piece ends up, which can be under an
+    // overhang it had to slide or rotate into
+    int x;
+    int y;
+} solverplacement_t;
+
+typedef struct solverresult_s
+{
+    bool solved;
+    int numPlacements;
+    solverplacement_t placements[SOLVER_MAX_PIECES];
+
+    uint64_t nodes;
+    // in seconds
+    double time;
+} solverresult_t;
+
+// numThreads of 0 uses one thread per cpu
+solver_t* G_CreateSolver(struct alloc_s* alloc, int numThreads);
+
+void G_DestroySolver(solver_t* solver);
+
+// tries to clear every block off the board using the pieces of the queue
+// in order, and at most maxPieces of them
+// returns false if the board or queue can't be searched at all
+bool G_SolvePerfectClear(solver_t* solver, struct board_s* board, const piecetype_t* queue, int queueLength, int maxPieces, solverresult_t* result);
+
+#endif  // TEBRIS_G_SOLVER_H
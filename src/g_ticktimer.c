@@ -17,6 +17,8 @@
 
 #include "g_ticktimer.h"
 
+#include <stdbool.h>
+
 #include "SDL.h"
 
 #include "s_alloc.h"
@@ -25,6 +27,9 @@ struct ticktimer_s
 {
     alloc_t* alloc;
     uint64_t startTime;
+
+    bool paused;
+    uint64_t pausedTime;
 };
 
 ticktimer_t* G_CreateTimer(struct alloc_s* alloc)
@@ -36,6 +41,7 @@ ticktimer_t* G_CreateTimer(struct alloc_s* alloc)
     timer->alloc = alloc;
 
     timer->startTime = SDL_GetTicks64();
+    timer->paused = false;
 
     return timer;
 }
@@ -47,8 +53,45 @@ void G_DestroyTimer(ticktimer_t* timer)
     SDL_QuitSubSystem(SDL_INIT_TIMER);
 }
 
+// in ms, not counting time spent paused
+static uint64_t GetElapsed(ticktimer_t* timer)
+{
+    const uint64_t now = timer->paused ? timer->pausedTime : SDL_GetTicks64();
+    return now - timer->startTime;
+}
+
 uint64_t G_GetTimerTicks(ticktimer_t* timer)
 {
-    const uint64_t ticks = SDL_GetTicks64() - timer->startTime;
+    const uint64_t ticks = GetElapsed(timer);
     return (ticks * TICK_RATE) / 1000;
 }
+
+uint64_t G_GetTimerTickTime(ticktimer_t* timer, uint64_t tick)
+{
+    // round up, G_GetTimerTicks only counts the tick once it's fully there
+    return timer->startTime + (tick * 1000 + TICK_RATE - 1) / TICK_RATE;
+}
+
+void G_PauseTimer(ticktimer_t* timer)
+{
+    if (timer->paused)
+    {
+        return;
+    }
+
+    timer->pausedTime = SDL_GetTicks64();
+    timer->paused = true;
+}
+
+void G_ResumeTimer(ticktimer_t* timer)
+{
+    if (!timer->paused)
+    {
+        return;
+    }
+
+    // move the start up by however long we were paused, so there's
+    // nothing to catch up on
+    timer->startTime += SDL_GetTicks64() - timer->pausedTime;
+    timer->paused = false;
+}
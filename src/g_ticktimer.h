@@ -33,4 +33,13 @@ void G_DestroyTimer(ticktimer_t* timer);
 
 uint64_t G_GetTimerTicks(ticktimer_t* timer);
 
+// no ticks go by while paused, resuming carries on from where it paused
+void G_PauseTimer(ticktimer_t* timer);
+
+void G_ResumeTimer(ticktimer_t* timer);
+
+// when the given tick is due, in SDL_GetTicks64 time
+// only makes sense while the timer isn't paused
+uint64_t G_GetTimerTickTime(ticktimer_t* timer, uint64_t tick);
+
 #endif  // TEBRIS_G_TICKTIMER_H
@@ -43,9 +43,10 @@ void S_DestroyAlloc(alloc_t* alloc)
         return;
     }
 
-    printf("Bytes allocated: %d\n", alloc->totalAlloc);
+    // stderr so it doesn't get mixed up with what tools print
+    fprintf(stderr, "Bytes allocated: %d\n", alloc->totalAlloc);
     if (alloc->numAllocs > 0)
-        printf("Uh oh, memory leaks?: %d\n", alloc->numAllocs);
+        fprintf(stderr, "Uh oh, memory leaks?: %d\n", alloc->numAllocs);
     free(alloc);
 }
 
@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "s_queue.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+
+struct queue_s
+{
+    alloc_t* alloc;
+
+    uint8_t* data;
+    size_t elemSize;
+    size_t capacity;
+
+    // only written by the consumer
+    SDL_atomic_t head;
+    // only written by the producer
+    SDL_atomic_t tail;
+};
+
+queue_t* S_CreateQueue(struct alloc_s* alloc, size_t elemSize, size_t capacity)
+{
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity)
+    {
+        roundedCapacity <<= 1;
+    }
+
+    queue_t* queue = S_Allocate(alloc, sizeof(queue_t));
+    if (!queue)
+    {
+        fputs("Failed to allocate memory for queue\n", stderr);
+        return NULL;
+    }
+
+    queue->alloc = alloc;
+
+    queue->data = S_Allocate(alloc, elemSize * roundedCapacity);
+    if (!queue->data)
+    {
+        fputs("Failed to allocate memory for queue data\n", stderr);
+        S_Free(alloc, queue);
+        return NULL;
+    }
+
+    queue->elemSize = elemSize;
+    queue->capacity = roundedCapacity;
+
+    SDL_AtomicSet(&queue->head, 0);
+    SDL_AtomicSet(&queue->tail, 0);
+
+    return queue;
+}
+
+void S_DestroyQueue(queue_t* queue)
+{
+    if (!queue)
+    {
+        return;
+    }
+
+    S_Free(queue->alloc, queue->data);
+
+    S_Free(queue->alloc, queue);
+}
+
+bool S_QueuePush(queue_t* queue, const void* elem)
+{
+    const unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+    const unsigned int head = (unsigned int)SDL_AtomicGet(&queue->head);
+
+    if (tail - head >= queue->capacity)
+    {
+        return false;
+    }
+
+    memcpy(queue->data + (tail & (queue->capacity - 1)) * queue->elemSize, elem, queue->elemSize);
+
+    // the element has to be visible before the consumer can see the new tail
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->tail, (int)(tail + 1));
+
+    return true;
+}
+
+bool S_QueuePop(queue_t* queue, void* elem)
+{
+    const unsigned int head = (unsigned int)SDL_AtomicGet(&queue->head);
+    const unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    SDL_MemoryBarrierAcquire();
+    memcpy(elem, queue->data + (head & (queue->capacity - 1)) * queue->elemSize, queue->elemSize);
+
+    // don't let the producer overwrite the slot until we're done copying it
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->head, (int)(head + 1));
+
+    return true;
+}
+
+bool S_QueuePeek(queue_t* queue, void* elem)
+{
+    const unsigned int head = (unsigned int)SDL_AtomicGet(&queue->head);
+    const unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    // the producer can't touch the slot until head moves past it
+    SDL_MemoryBarrierAcquire();
+    memcpy(elem, queue->data + (head & (queue->capacity - 1)) * queue->elemSize, queue->elemSize);
+
+    return true;
+}
+
+size_t S_QueueCount(queue_t* queue)
+{
+    const unsigned int head = (unsigned int)SDL_AtomicGet(&queue->head);
+    const unsigned int tail = (unsigned int)SDL_AtomicGet(&queue->tail);
+
+    return tail - head;
+}
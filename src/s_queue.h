@@ -0,0 +1,47 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_S_QUEUE_H
+#define TEBRIS_S_QUEUE_H
+
+#include <stdbool.h>
+#include <string.h>
+
+struct alloc_s;
+
+// fixed size lock-free queue of fixed size elements
+// only safe with exactly one thread pushing and one thread popping
+typedef struct queue_s queue_t;
+
+// capacity gets rounded up to a power of two
+queue_t* S_CreateQueue(struct alloc_s* alloc, size_t elemSize, size_t capacity);
+
+void S_DestroyQueue(queue_t* queue);
+
+// returns false when the queue is full, never blocks
+bool S_QueuePush(queue_t* queue, const void* elem);
+
+// returns false when the queue is empty, never blocks
+bool S_QueuePop(queue_t* queue, void* elem);
+
+// what S_QueuePop would give, without taking it off
+// only for the popping thread
+bool S_QueuePeek(queue_t* queue, void* elem);
+
+size_t S_QueueCount(queue_t* queue);
+
+#endif  // TEBRIS_S_QUEUE_H
@@ -0,0 +1,91 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "s_triple.h"
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+
+// set on the middle index when the reader hasn't picked it up yet
+#define FRESH (4)
+#define INDEX_MASK (3)
+
+struct triple_s
+{
+    alloc_t* alloc;
+
+    // only touched by the writer
+    int writeIndex;
+    // only touched by the reader
+    int readIndex;
+    // the one in between, swapped with either side
+    SDL_atomic_t middle;
+};
+
+triple_t* S_CreateTriple(struct alloc_s* alloc)
+{
+    triple_t* triple = S_Allocate(alloc, sizeof(triple_t));
+    if (!triple)
+    {
+        fputs("Failed to allocate memory for triple buffer\n", stderr);
+        return NULL;
+    }
+
+    triple->alloc = alloc;
+
+    triple->writeIndex = 0;
+    SDL_AtomicSet(&triple->middle, 1);
+    triple->readIndex = 2;
+
+    return triple;
+}
+
+void S_DestroyTriple(triple_t* triple)
+{
+    S_Free(triple->alloc, triple);
+}
+
+int S_TripleWriteIndex(triple_t* triple)
+{
+    return triple->writeIndex;
+}
+
+void S_TriplePublish(triple_t* triple)
+{
+    // everything written to the buffer has to land before the reader can
+    // see it
+    SDL_MemoryBarrierRelease();
+
+    const int old = SDL_AtomicSet(&triple->middle, triple->writeIndex | FRESH);
+    triple->writeIndex = old & INDEX_MASK;
+}
+
+int S_TripleReadIndex(triple_t* triple)
+{
+    if (SDL_AtomicGet(&triple->middle) & FRESH)
+    {
+        const int old = SDL_AtomicSet(&triple->middle, triple->readIndex);
+        triple->readIndex = old & INDEX_MASK;
+
+        SDL_MemoryBarrierAcquire();
+    }
+
+    return triple->readIndex;
+}
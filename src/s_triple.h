@@ -0,0 +1,42 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_S_TRIPLE_H
+#define TEBRIS_S_TRIPLE_H
+
+struct alloc_s;
+
+// lock-free triple buffer, one thread writes & one thread reads, neither
+// ever waits on the other
+// only hands out indices 0 to 2, the buffers themselves belong to the caller
+typedef struct triple_s triple_t;
+
+triple_t* S_CreateTriple(struct alloc_s* alloc);
+
+void S_DestroyTriple(triple_t* triple);
+
+// buffer the writer should fill in next
+int S_TripleWriteIndex(triple_t* triple);
+
+// hands the filled in buffer over to the reader
+void S_TriplePublish(triple_t* triple);
+
+// buffer the reader should use, the newest one published
+// the reader owns it until the next call
+int S_TripleReadIndex(triple_t* triple);
+
+#endif  // TEBRIS_S_TRIPLE_H
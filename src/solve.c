@@ -0,0 +1,267 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// command line perfect clear solver
+//
+// usage: blockgam-solve [-n max pieces] [-j threads] <board file or -> <queue>
+//
+// the board file has one line per row, top row first, with '.' for empty
+// spaces and anything else for blocks
+// the queue is a string of piece letters, eg. "TLJOSZI"
+
+#define SDL_MAIN_HANDLED
+#include "SDL.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "g_board.h"
+#include "g_piece.h"
+#include "g_solver.h"
+#include "s_alloc.h"
+
+static const char pieceLetters[PIECETYPE_END] = {
+    [PIECETYPE_T] = 'T',
+    [PIECETYPE_L] = 'L',
+    [PIECETYPE_J] = 'J',
+    [PIECETYPE_BLOCK] = 'O',
+    [PIECETYPE_S] = 'S',
+    [PIECETYPE_Z] = 'Z',
+    [PIECETYPE_LONG] = 'I',
+};
+
+static void Usage(void)
+{
+    fputs("usage: blockgam-solve [-n max pieces] [-j threads] <board file or -> <queue>\n", stderr);
+}
+
+static bool ReadBoard(board_t* board, const char* path)
+{
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "Couldn't open board file %s\n", path);
+        return false;
+    }
+
+    char lines[GRID_HEIGHT][GRID_WIDTH + 2];
+    int numLines = 0;
+    char line[256];
+    while (fgets(line, sizeof line, file))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0')
+        {
+            continue;
+        }
+
+        if (numLines == GRID_HEIGHT || strlen(line) != GRID_WIDTH)
+        {
+            fprintf(stderr, "Board has to be at most %d rows of %d spaces\n", GRID_HEIGHT, GRID_WIDTH);
+            if (file != stdin)
+                fclose(file);
+            return false;
+        }
+
+        memcpy(lines[numLines++], line, GRID_WIDTH + 1);
+    }
+
+    if (file != stdin)
+        fclose(file);
+
+    // the file is written top down but the board counts up from the bottom
+    for (int i = 0; i < numLines; i++)
+    {
+        const int y = numLines - 1 - i;
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            G_SetBoardSpace(board, x, y, lines[i][x] == '.' ? 0 : 8);
+        }
+    }
+
+    return true;
+}
+
+static int ReadQueue(piecetype_t* queue, int maxLength, const char* text)
+{
+    int length = 0;
+    for (const char* c = text; *c; c++)
+    {
+        int type = 0;
+        while (type < PIECETYPE_END && pieceLetters[type] != *c && pieceLetters[type] != *c - 'a' + 'A')
+        {
+            type++;
+        }
+
+        if (type == PIECETYPE_END)
+        {
+            fprintf(stderr, "Unknown piece '%c', use one of TLJOSZI\n", *c);
+            return -1;
+        }
+
+        if (length == maxLength)
+        {
+            fprintf(stderr, "Queue can't be longer than %d pieces\n", maxLength);
+            return -1;
+        }
+
+        queue[length++] = type;
+    }
+
+    return length;
+}
+
+static void PrintBoard(board_t* board, int rows)
+{
+    for (int y = rows - 1; y >= 0; y--)
+    {
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            const uint8_t c = G_GetBoardSpace(board, x, y);
+            putchar(c == 0 ? '.' : (c < PIECETYPE_END + 1 ? pieceLetters[c - 1] : '#'));
+        }
+        putchar('\n');
+    }
+}
+
+// play the solution out with the normal game pieces to show it
+static void PrintSolution(alloc_t* alloc, board_t* board, const solverresult_t* result)
+{
+    piece_t* piece = G_AllocatePiece(alloc);
+
+    // pieces get lined up on an empty board, since some placements are
+    // tucked under blocks a straight drop would hit
+    board_t* empty = G_CreateBoard(alloc);
+
+    for (int i = 0; i < result->numPlacements; i++)
+    {
+        const solverplacement_t* placement = &result->placements[i];
+
+        G_CreatePiece(piece, placement->type, SPAWN_X, SPAWN_Y);
+        for (int r = 0; r < placement->rotations; r++)
+        {
+            G_TryPieceRotate(piece, empty);
+        }
+        while (G_GetPieceX(piece) < placement->x && G_TryPieceRight(piece, empty))
+        {
+        }
+        while (G_GetPieceX(piece) > placement->x && G_TryPieceLeft(piece, empty))
+        {
+        }
+        while (G_GetPieceY(piece) > placement->y && G_TryPieceDrop(piece, empty))
+        {
+        }
+
+        printf("%d: %c rotate %d, column %d, row %d\n", i + 1, pieceLetters[placement->type], placement->rotations, placement->x, placement->y);
+
+        G_InsertPiece(piece, board);
+        PrintBoard(board, SOLVER_MAX_ROWS);
+        putchar('\n');
+
+        while (G_TryBoardClear(board))
+        {
+        }
+    }
+
+    G_DestroyBoard(empty);
+    G_DestroyPiece(piece);
+}
+
+int main(int argc, char** argv)
+{
+    int maxPieces = SOLVER_MAX_PIECES;
+    int numThreads = 0;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++)
+    {
+        if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+        {
+            maxPieces = atoi(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+        {
+            numThreads = atoi(argv[++arg]);
+        }
+        else
+        {
+            Usage();
+            return 1;
+        }
+    }
+
+    if (argc - arg != 2)
+    {
+        Usage();
+        return 1;
+    }
+
+    alloc_t* alloc = S_CreateAlloc();
+    if (!alloc)
+    {
+        fputs("Failed to initialize memory allocator\n", stderr);
+        return 1;
+    }
+
+    board_t* board = G_CreateBoard(alloc);
+    piecetype_t queue[SOLVER_MAX_PIECES];
+    const int queueLength = ReadQueue(queue, SOLVER_MAX_PIECES, argv[arg + 1]);
+
+    solver_t* solver = NULL;
+    solverresult_t result;
+    int ret = 1;
+
+    if (queueLength < 0 || !ReadBoard(board, argv[arg]))
+    {
+        goto done;
+    }
+
+    if (!(solver = G_CreateSolver(alloc, numThreads)))
+    {
+        fputs("Failed to initialize solver\n", stderr);
+        goto done;
+    }
+
+    if (!G_SolvePerfectClear(solver, board, queue, queueLength, maxPieces, &result))
+    {
+        goto done;
+    }
+
+    if (result.solved)
+    {
+        printf("Perfect clear in %d pieces\n\n", result.numPlacements);
+        PrintSolution(alloc, board, &result);
+        ret = 0;
+    }
+    else
+    {
+        // the search covers every placement the game's moves can reach,
+        // so nothing found means there really isn't one
+        printf("No perfect clear within %d pieces\n", maxPieces < queueLength ? maxPieces : queueLength);
+        ret = 2;
+    }
+
+    printf("Searched %llu nodes in %.3f s\n", (unsigned long long)result.nodes, result.time);
+
+done:
+    G_DestroySolver(solver);
+    G_DestroyBoard(board);
+    S_DestroyAlloc(alloc);
+
+    return ret;
+}
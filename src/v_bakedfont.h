@@ -0,0 +1,50 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_V_BAKEDFONT_H
+#define TEBRIS_V_BAKEDFONT_H
+
+#include <stdint.h>
+
+// printable ascii, the same glyphs the atlas in v_video.c holds
+#define BAKED_FIRST_GLYPH (32)
+#define BAKED_NUM_GLYPHS (95)
+
+typedef struct bakedglyph_s
+{
+    // where it is in the atlas, nothing to draw if w is 0
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    // how far along the next one goes
+    int16_t advance;
+} bakedglyph_t;
+
+// a glyph atlas worked out by blockgam-bakefont when building, so the game
+// can upload it without opening a font
+typedef struct bakedfont_s
+{
+    int size;
+    int width;
+    int height;
+    // one bit a pixel, high bit first, each row straight after the last
+    const uint8_t* bits;
+    bakedglyph_t glyphs[BAKED_NUM_GLYPHS];
+} bakedfont_t;
+
+#endif  // TEBRIS_V_BAKEDFONT_H
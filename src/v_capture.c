@@ -0,0 +1,380 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "v_capture.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+#include "s_queue.h"
+
+// frames that can be waiting on the writer at once
+#define NUM_CAPTURE_BUFFERS (8)
+
+#define MAX_PATH_LENGTH (256)
+
+typedef enum captureformat_e
+{
+    CAPTUREFORMAT_PPM,
+    CAPTUREFORMAT_Y4M,
+} captureformat_t;
+
+struct capture_s
+{
+    alloc_t* alloc;
+
+    captureformat_t format;
+    char path[MAX_PATH_LENGTH];
+
+    int width;
+    int height;
+
+    // ARGB8888 frames, handed back & forth by index
+    uint32_t* buffers[NUM_CAPTURE_BUFFERS];
+    // main thread takes from here, the writer gives back
+    queue_t* freeBuffers;
+    // main thread gives, the writer takes
+    queue_t* fullBuffers;
+
+    SDL_Thread* thread;
+    SDL_sem* wake;
+    SDL_atomic_t running;
+
+    // only the writer touches these
+    FILE* video;
+    uint8_t* converted;
+    int written;
+
+    // only the main thread touches these
+    int dropped;
+    // already said frames are being dropped for being the wrong size
+    bool sizeWarned;
+    // taken from the free queue but not filled, only the writer can give
+    // buffers back so it hangs on to it for next time
+    int heldBuffer;
+};
+
+// one %d, with maybe some digits for padding, & nothing else that
+// printf would pick up
+static bool IsFramePattern(const char* path)
+{
+    const char* percent = strchr(path, '%');
+    if (!percent || strchr(percent + 1, '%'))
+    {
+        return false;
+    }
+
+    const char* c = percent + 1;
+    while (*c >= '0' && *c <= '9')
+    {
+        c++;
+    }
+
+    return *c == 'd';
+}
+
+static bool EndsWith(const char* str, const char* end)
+{
+    const size_t strLength = strlen(str);
+    const size_t endLength = strlen(end);
+
+    return strLength >= endLength && strcmp(str + strLength - endLength, end) == 0;
+}
+
+static void WritePPM(capture_t* capture, const uint32_t* pixels)
+{
+    char path[MAX_PATH_LENGTH + 16];
+    snprintf(path, sizeof path, capture->path, capture->written);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s for capture\n", path);
+        return;
+    }
+
+    uint8_t* rgb = capture->converted;
+    for (int i = 0; i < capture->width * capture->height; i++)
+    {
+        rgb[i * 3] = (pixels[i] >> 16) & 0xff;
+        rgb[i * 3 + 1] = (pixels[i] >> 8) & 0xff;
+        rgb[i * 3 + 2] = pixels[i] & 0xff;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", capture->width, capture->height);
+    fwrite(rgb, 3, capture->width * capture->height, file);
+    fclose(file);
+}
+
+// 4:4:4 so there's no need to average neighbouring pixels, bt.601 with
+// the usual 16 - 235 range
+static void WriteY4M(capture_t* capture, const uint32_t* pixels)
+{
+    const int area = capture->width * capture->height;
+    uint8_t* y = capture->converted;
+    uint8_t* u = y + area;
+    uint8_t* v = u + area;
+
+    for (int i = 0; i < area; i++)
+    {
+        const int r = (pixels[i] >> 16) & 0xff;
+        const int g = (pixels[i] >> 8) & 0xff;
+        const int b = pixels[i] & 0xff;
+
+        // kept positive before shifting
+        y[i] = (uint8_t)((66 * r + 129 * g + 25 * b + 128 + (16 << 8)) >> 8);
+        u[i] = (uint8_t)((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+        v[i] = (uint8_t)((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+    }
+
+    fputs("FRAME\n", capture->video);
+    fwrite(capture->converted, 3, area, capture->video);
+}
+
+static int WriterThread(void* data)
+{
+    capture_t* capture = data;
+
+    while (true)
+    {
+        // keep going until everything that was captured is written
+        const bool running = SDL_AtomicGet(&capture->running);
+
+        int index;
+        while (S_QueuePop(capture->fullBuffers, &index))
+        {
+            if (capture->format == CAPTUREFORMAT_Y4M)
+                WriteY4M(capture, capture->buffers[index]);
+            else
+                WritePPM(capture, capture->buffers[index]);
+
+            capture->written++;
+            S_QueuePush(capture->freeBuffers, &index);
+        }
+
+        if (!running)
+        {
+            break;
+        }
+
+        SDL_SemWait(capture->wake);
+    }
+
+    return 0;
+}
+
+capture_t* V_CreateCapture(struct alloc_s* alloc, const char* path, int width, int height, int frameRate)
+{
+    const bool y4m = EndsWith(path, ".y4m");
+    if (!y4m && !IsFramePattern(path))
+    {
+        fprintf(stderr, "Capture path %s needs to end in .y4m or have a %%d for the frame number\n", path);
+        return NULL;
+    }
+
+    if (strlen(path) >= MAX_PATH_LENGTH)
+    {
+        fputs("Capture path is too long\n", stderr);
+        return NULL;
+    }
+
+    capture_t* capture = S_Allocate(alloc, sizeof(capture_t));
+    if (!capture)
+    {
+        fputs("Failed to allocate memory for capture\n", stderr);
+        return NULL;
+    }
+
+    capture->alloc = alloc;
+    capture->format = y4m ? CAPTUREFORMAT_Y4M : CAPTUREFORMAT_PPM;
+    strcpy(capture->path, path);
+
+    capture->width = width;
+    capture->height = height;
+
+    capture->heldBuffer = -1;
+
+    if (!(capture->freeBuffers = S_CreateQueue(alloc, sizeof(int), NUM_CAPTURE_BUFFERS)) ||
+        !(capture->fullBuffers = S_CreateQueue(alloc, sizeof(int), NUM_CAPTURE_BUFFERS)))
+    {
+        fputs("Failed to create capture queues\n", stderr);
+        V_DestroyCapture(capture);
+        return NULL;
+    }
+
+    for (int i = 0; i < NUM_CAPTURE_BUFFERS; i++)
+    {
+        if (!(capture->buffers[i] = S_Allocate(alloc, sizeof(uint32_t) * width * height)))
+        {
+            fputs("Failed to allocate memory for capture buffers\n", stderr);
+            V_DestroyCapture(capture);
+            return NULL;
+        }
+
+        S_QueuePush(capture->freeBuffers, &i);
+    }
+
+    // rgb or three full size planes, either way three bytes a pixel
+    if (!(capture->converted = S_Allocate(alloc, 3 * width * height)))
+    {
+        fputs("Failed to allocate memory for capture conversion\n", stderr);
+        V_DestroyCapture(capture);
+        return NULL;
+    }
+
+    if (y4m)
+    {
+        if (!(capture->video = fopen(path, "wb")))
+        {
+            fprintf(stderr, "Failed to open %s for capture\n", path);
+            V_DestroyCapture(capture);
+            return NULL;
+        }
+
+        fprintf(capture->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, frameRate);
+    }
+
+    if (!(capture->wake = SDL_CreateSemaphore(0)))
+    {
+        fputs("Failed to create capture semaphore\n", stderr);
+        V_DestroyCapture(capture);
+        return NULL;
+    }
+
+    SDL_AtomicSet(&capture->running, 1);
+    if (!(capture->thread = SDL_CreateThread(WriterThread, "capture", capture)))
+    {
+        fputs("Failed to start capture thread\n", stderr);
+        V_DestroyCapture(capture);
+        return NULL;
+    }
+
+    return capture;
+}
+
+void V_DestroyCapture(capture_t* capture)
+{
+    if (capture->thread)
+    {
+        SDL_AtomicSet(&capture->running, 0);
+        SDL_SemPost(capture->wake);
+        SDL_WaitThread(capture->thread, NULL);
+
+        printf("Captured %d frames, dropped %d\n", capture->written, capture->dropped);
+    }
+
+    if (capture->wake)
+        SDL_DestroySemaphore(capture->wake);
+
+    if (capture->video)
+        fclose(capture->video);
+
+    if (capture->converted)
+        S_Free(capture->alloc, capture->converted);
+
+    for (int i = 0; i < NUM_CAPTURE_BUFFERS; i++)
+    {
+        if (capture->buffers[i])
+            S_Free(capture->alloc, capture->buffers[i]);
+    }
+
+    if (capture->fullBuffers)
+        S_DestroyQueue(capture->fullBuffers);
+
+    if (capture->freeBuffers)
+        S_DestroyQueue(capture->freeBuffers);
+
+    S_Free(capture->alloc, capture);
+}
+
+// a free buffer to put the next frame in, or -1 if the frame has to be
+// dropped
+static int TakeBuffer(capture_t* capture, int width, int height)
+{
+    if (width != capture->width || height != capture->height)
+    {
+        // otherwise the only sign is the count at the end
+        if (!capture->sizeWarned)
+        {
+            fprintf(stderr, "Frames are %dx%d but the capture is %dx%d, dropping them until it's back "
+                            "(BLOCKGAM_RENDER_SIZE keeps it fixed)\n", width, height, capture->width, capture->height);
+            capture->sizeWarned = true;
+        }
+
+        capture->dropped++;
+        return -1;
+    }
+
+    capture->sizeWarned = false;
+
+    int index = capture->heldBuffer;
+    if (index < 0 && !S_QueuePop(capture->freeBuffers, &index))
+    {
+        // the writer is behind
+        capture->dropped++;
+        return -1;
+    }
+
+    return index;
+}
+
+static void GiveBuffer(capture_t* capture, int index)
+{
+    capture->heldBuffer = -1;
+    S_QueuePush(capture->fullBuffers, &index);
+    SDL_SemPost(capture->wake);
+}
+
+void V_CaptureFrame(capture_t* capture, SDL_Renderer* renderer, int width, int height)
+{
+    const int index = TakeBuffer(capture, width, height);
+    if (index < 0)
+    {
+        return;
+    }
+
+    const SDL_Rect rect = { 0, 0, width, height };
+    if (SDL_RenderReadPixels(renderer, &rect, SDL_PIXELFORMAT_ARGB8888, capture->buffers[index], width * sizeof(uint32_t)) != 0)
+    {
+        capture->dropped++;
+        capture->heldBuffer = index;
+        return;
+    }
+
+    GiveBuffer(capture, index);
+}
+
+void V_CaptureFramePixels(capture_t* capture, const void* pixels, int pitch, int width, int height)
+{
+    const int index = TakeBuffer(capture, width, height);
+    if (index < 0)
+    {
+        return;
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        memcpy(capture->buffers[index] + y * width, (const uint8_t*)pixels + y * pitch, sizeof(uint32_t) * width);
+    }
+
+    GiveBuffer(capture, index);
+}
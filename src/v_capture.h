@@ -0,0 +1,45 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_V_CAPTURE_H
+#define TEBRIS_V_CAPTURE_H
+
+struct alloc_s;
+struct SDL_Renderer;
+
+// records every frame drawn, the main thread only reads pixels back into
+// a free buffer & a writer thread does the rest, if it falls behind
+// frames get dropped instead of piling up
+typedef struct capture_s capture_t;
+
+// a path ending in .y4m writes one raw video, otherwise it needs a %d
+// (or %05d & so on) for the frame number & each frame is its own .ppm
+capture_t* V_CreateCapture(struct alloc_s* alloc, const char* path, int width, int height, int frameRate);
+
+// writes out whatever's left & says how many frames got dropped
+void V_DestroyCapture(capture_t* capture);
+
+// grabs what's been drawn to the current render target, frames that
+// aren't the size the capture started with get dropped, with a warning
+// when that starts
+void V_CaptureFrame(capture_t* capture, struct SDL_Renderer* renderer, int width, int height);
+
+// same, but copies a frame that's already in memory, ARGB8888 or
+// XRGB8888 with pitch bytes from one row to the next
+void V_CaptureFramePixels(capture_t* capture, const void* pixels, int pitch, int width, int height);
+
+#endif  // TEBRIS_V_CAPTURE_H
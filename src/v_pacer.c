@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "v_pacer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+
+// frames to watch before deciding whether present blocks
+#define CALIBRATE_FRAMES (60)
+// anything longer is the game sleeping on an idle screen, not a frame
+#define MAX_FRAME_TIME (0.1)
+// sleeps wake up this early, then spin for the rest
+#define SPIN_TIME (0.002)
+
+struct pacer_s
+{
+    alloc_t* alloc;
+
+    uint64_t frequency;
+    // time between frames, in performance counter ticks
+    uint64_t interval;
+
+    bool limiting;
+    uint64_t lastFrame;
+    uint64_t nextFrame;
+
+    // frames & time spent in present while deciding whether to limit
+    int calibrateFrames;
+    uint64_t calibrateFrameTime;
+    uint64_t calibratePresentTime;
+
+    // running mean & variance of frame times in ms, using welford's method
+    uint64_t numFrames;
+    double mean;
+    double m2;
+    double worst;
+};
+
+pacer_t* V_CreatePacer(struct alloc_s* alloc, int refreshRate, int frameLimit, bool vsync)
+{
+    pacer_t* pacer = S_Allocate(alloc, sizeof(pacer_t));
+    if (!pacer)
+    {
+        fputs("Failed to allocate memory for frame pacer\n", stderr);
+        return NULL;
+    }
+
+    pacer->alloc = alloc;
+
+    if (refreshRate <= 0)
+        refreshRate = 60;
+
+    const int rate = frameLimit > 0 ? frameLimit : refreshRate;
+
+    pacer->frequency = SDL_GetPerformanceFrequency();
+    pacer->interval = pacer->frequency / rate;
+
+    pacer->limiting = frameLimit > 0 || !vsync;
+    // no point checking if we're limiting anyway
+    pacer->calibrateFrames = pacer->limiting ? CALIBRATE_FRAMES : 0;
+
+    pacer->lastFrame = SDL_GetPerformanceCounter();
+    pacer->nextFrame = pacer->lastFrame + pacer->interval;
+
+    return pacer;
+}
+
+void V_DestroyPacer(pacer_t* pacer)
+{
+    if (pacer->numFrames > 1)
+    {
+        const double stdDev = SDL_sqrt(pacer->m2 / (pacer->numFrames - 1));
+        printf("Frame time: %.2f ms average, %.2f ms std dev, %.2f ms worst over %llu frames\n",
+               pacer->mean, stdDev, pacer->worst, (unsigned long long)pacer->numFrames);
+    }
+
+    S_Free(pacer->alloc, pacer);
+}
+
+static void RecordFrame(pacer_t* pacer, uint64_t frameTime)
+{
+    const double ms = frameTime * 1000.0 / pacer->frequency;
+    if (ms > MAX_FRAME_TIME * 1000.0)
+    {
+        return;
+    }
+
+    pacer->numFrames++;
+    const double delta = ms - pacer->mean;
+    pacer->mean += delta / pacer->numFrames;
+    pacer->m2 += delta * (ms - pacer->mean);
+
+    if (ms > pacer->worst)
+        pacer->worst = ms;
+}
+
+// vsync'd presents wait for most of the frame, and frames don't come
+// much faster than the refresh rate, if neither is true then present
+// isn't blocking
+static void Calibrate(pacer_t* pacer, uint64_t frameTime, uint64_t presentTime)
+{
+    if (frameTime * 1.0 / pacer->frequency > MAX_FRAME_TIME)
+    {
+        return;
+    }
+
+    pacer->calibrateFrameTime += frameTime;
+    pacer->calibratePresentTime += presentTime;
+
+    if (++pacer->calibrateFrames < CALIBRATE_FRAMES)
+    {
+        return;
+    }
+
+    const uint64_t averageFrame = pacer->calibrateFrameTime / CALIBRATE_FRAMES;
+    const uint64_t averagePresent = pacer->calibratePresentTime / CALIBRATE_FRAMES;
+
+    if (averageFrame < pacer->interval * 3 / 4 && averagePresent < pacer->interval / 8)
+    {
+        printf("Present doesn't wait for vsync, limiting to %d fps\n", (int)(pacer->frequency / pacer->interval));
+        pacer->limiting = true;
+        pacer->nextFrame = SDL_GetPerformanceCounter() + pacer->interval;
+    }
+}
+
+static void WaitForNextFrame(pacer_t* pacer)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    if (now < pacer->nextFrame)
+    {
+        // SDL_Delay can oversleep by a fair bit, so only sleep most of the way
+        const double remaining = (double)(pacer->nextFrame - now) / pacer->frequency;
+        if (remaining > SPIN_TIME)
+        {
+            SDL_Delay((uint32_t)((remaining - SPIN_TIME) * 1000.0));
+        }
+
+        while (SDL_GetPerformanceCounter() < pacer->nextFrame)
+        {
+            // spin
+        }
+
+        pacer->nextFrame += pacer->interval;
+    }
+    else if (now - pacer->nextFrame > pacer->interval)
+    {
+        // too far behind, don't rush frames out to catch up
+        pacer->nextFrame = now + pacer->interval;
+    }
+    else
+    {
+        pacer->nextFrame += pacer->interval;
+    }
+}
+
+void V_PacerPresent(pacer_t* pacer, SDL_Renderer* renderer)
+{
+    const uint64_t presentStart = SDL_GetPerformanceCounter();
+    SDL_RenderPresent(renderer);
+    const uint64_t presentEnd = SDL_GetPerformanceCounter();
+
+    if (pacer->limiting)
+    {
+        WaitForNextFrame(pacer);
+    }
+
+    const uint64_t now = SDL_GetPerformanceCounter();
+    const uint64_t frameTime = now - pacer->lastFrame;
+    pacer->lastFrame = now;
+
+    if (pacer->calibrateFrames < CALIBRATE_FRAMES)
+    {
+        Calibrate(pacer, frameTime, presentEnd - presentStart);
+    }
+
+    RecordFrame(pacer, frameTime);
+}
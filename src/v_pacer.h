@@ -0,0 +1,42 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_V_PACER_H
+#define TEBRIS_V_PACER_H
+
+#include <stdbool.h>
+
+struct alloc_s;
+struct SDL_Renderer;
+
+// keeps frames evenly spaced when presenting doesn't wait for vsync,
+// which some drivers quietly ignore
+typedef struct pacer_s pacer_t;
+
+// refreshRate of 0 means it's unknown & 60 gets used
+// frameLimit above 0 always limits to that many frames a second, so does
+// not having vsync, otherwise the pacer only steps in if presenting turns
+// out not to block
+pacer_t* V_CreatePacer(struct alloc_s* alloc, int refreshRate, int frameLimit, bool vsync);
+
+// prints how steady the frame times were
+void V_DestroyPacer(pacer_t* pacer);
+
+// presents, then waits for the next frame if needed
+void V_PacerPresent(pacer_t* pacer, struct SDL_Renderer* renderer);
+
+#endif  // TEBRIS_V_PACER_H
@@ -0,0 +1,260 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "v_particles.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+
+// spaces a second squared
+#define GRAVITY (30.0f)
+
+// each array holds one thing about every particle, so the update loops
+// only walk through what they use & can be vectorised
+struct particles_s
+{
+    alloc_t* alloc;
+
+    int count;
+    int capacity;
+
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    // seconds left
+    float* life;
+    // one over the starting life, for fading out
+    float* fade;
+    float* size;
+    SDL_Color* color;
+
+    // filled in every draw, the indices never change
+    SDL_Vertex* vertices;
+    int* indices;
+
+    uint32_t seed;
+};
+
+particles_t* V_CreateParticles(struct alloc_s* alloc, int capacity)
+{
+    particles_t* particles = S_Allocate(alloc, sizeof(particles_t));
+    if (!particles)
+    {
+        fputs("Failed to allocate memory for particles\n", stderr);
+        return NULL;
+    }
+
+    particles->alloc = alloc;
+
+    particles->count = 0;
+    particles->capacity = capacity;
+
+    particles->x = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->y = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->vx = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->vy = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->life = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->fade = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->size = S_Allocate(alloc, sizeof(float) * capacity);
+    particles->color = S_Allocate(alloc, sizeof(SDL_Color) * capacity);
+    particles->vertices = S_Allocate(alloc, sizeof(SDL_Vertex) * 4 * capacity);
+    particles->indices = S_Allocate(alloc, sizeof(int) * 6 * capacity);
+
+    if (!particles->x || !particles->y || !particles->vx || !particles->vy ||
+        !particles->life || !particles->fade || !particles->size || !particles->color ||
+        !particles->vertices || !particles->indices)
+    {
+        fputs("Failed to allocate memory for particle arrays\n", stderr);
+        V_DestroyParticles(particles);
+        return NULL;
+    }
+
+    for (int i = 0; i < capacity; i++)
+    {
+        int* index = particles->indices + i * 6;
+        const int first = i * 4;
+
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first;
+        index[4] = first + 2;
+        index[5] = first + 3;
+    }
+
+    particles->seed = 0x9e3779b9u;
+
+    return particles;
+}
+
+void V_DestroyParticles(particles_t* particles)
+{
+    if (particles->indices)
+        S_Free(particles->alloc, particles->indices);
+    if (particles->vertices)
+        S_Free(particles->alloc, particles->vertices);
+    if (particles->color)
+        S_Free(particles->alloc, particles->color);
+    if (particles->size)
+        S_Free(particles->alloc, particles->size);
+    if (particles->fade)
+        S_Free(particles->alloc, particles->fade);
+    if (particles->life)
+        S_Free(particles->alloc, particles->life);
+    if (particles->vy)
+        S_Free(particles->alloc, particles->vy);
+    if (particles->vx)
+        S_Free(particles->alloc, particles->vx);
+    if (particles->y)
+        S_Free(particles->alloc, particles->y);
+    if (particles->x)
+        S_Free(particles->alloc, particles->x);
+
+    S_Free(particles->alloc, particles);
+}
+
+// -1 to 1, xorshift since these don't need to be any good
+static float Random(particles_t* particles)
+{
+    uint32_t s = particles->seed;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    particles->seed = s;
+
+    return (float)(s >> 8) / (float)(1 << 23) - 1.0f;
+}
+
+void V_EmitParticles(particles_t* particles, const emitter_t* emitter, int count)
+{
+    // out of room, nobody will miss a few
+    if (count > particles->capacity - particles->count)
+    {
+        count = particles->capacity - particles->count;
+    }
+
+    const SDL_Color color = { emitter->r, emitter->g, emitter->b, 255 };
+
+    for (int n = 0; n < count; n++)
+    {
+        const int i = particles->count++;
+
+        particles->x[i] = emitter->x + Random(particles) * emitter->spread;
+        particles->y[i] = emitter->y + Random(particles) * emitter->spread;
+        particles->vx[i] = Random(particles) * emitter->speed;
+        particles->vy[i] = Random(particles) * emitter->speed + emitter->lift;
+
+        // so they don't all vanish on the same frame
+        const float life = emitter->life * (0.75f + 0.25f * Random(particles));
+        particles->life[i] = life;
+        particles->fade[i] = 1.0f / life;
+
+        particles->size[i] = emitter->size;
+        particles->color[i] = color;
+    }
+}
+
+void V_UpdateParticles(particles_t* particles, float dt)
+{
+    const int count = particles->count;
+
+    float* restrict x = particles->x;
+    float* restrict y = particles->y;
+    float* restrict vx = particles->vx;
+    float* restrict vy = particles->vy;
+    float* restrict life = particles->life;
+
+    for (int i = 0; i < count; i++)
+    {
+        vy[i] -= GRAVITY * dt;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+
+    // fill holes left by dead particles with ones off the end, order
+    // doesn't matter
+    int i = 0;
+    while (i < particles->count)
+    {
+        if (life[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+
+        const int last = --particles->count;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        life[i] = life[last];
+        particles->fade[i] = particles->fade[last];
+        particles->size[i] = particles->size[last];
+        particles->color[i] = particles->color[last];
+    }
+}
+
+void V_DrawParticles(particles_t* particles, SDL_Renderer* renderer, float originX, float originY, float scale)
+{
+    if (particles->count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < particles->count; i++)
+    {
+        SDL_Vertex* v = particles->vertices + i * 4;
+
+        const float half = particles->size[i] * scale * 0.5f;
+        const float left = originX + particles->x[i] * scale - half;
+        const float top = originY - particles->y[i] * scale - half;
+        const float right = left + 2.0f * half;
+        const float bottom = top + 2.0f * half;
+
+        SDL_Color color = particles->color[i];
+        color.a = (uint8_t)(255.0f * SDL_min(particles->life[i] * particles->fade[i], 1.0f));
+
+        v[0] = (SDL_Vertex){ .position = { left, top }, .color = color };
+        v[1] = (SDL_Vertex){ .position = { right, top }, .color = color };
+        v[2] = (SDL_Vertex){ .position = { right, bottom }, .color = color };
+        v[3] = (SDL_Vertex){ .position = { left, bottom }, .color = color };
+    }
+
+    // untextured geometry blends however the renderer draws
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    SDL_RenderGeometry(renderer, NULL, particles->vertices, particles->count * 4, particles->indices, particles->count * 6);
+
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+}
+
+int V_CountParticles(particles_t* particles)
+{
+    return particles->count;
+}
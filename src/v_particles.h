@@ -0,0 +1,68 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_V_PARTICLES_H
+#define TEBRIS_V_PARTICLES_H
+
+#include <stdint.h>
+
+struct alloc_s;
+struct SDL_Renderer;
+
+// short lived coloured squares, everything is allocated up front & new
+// particles get dropped once it's full
+typedef struct particles_s particles_t;
+
+// how a bunch of particles start out, positions & speeds are in board
+// spaces, with y going up
+typedef struct emitter_s
+{
+    float x;
+    float y;
+    // how far from x & y they can start
+    float spread;
+
+    // random speed up to this in any direction
+    float speed;
+    // added straight up on top
+    float lift;
+
+    // seconds
+    float life;
+    float size;
+
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} emitter_t;
+
+particles_t* V_CreateParticles(struct alloc_s* alloc, int capacity);
+
+void V_DestroyParticles(particles_t* particles);
+
+void V_EmitParticles(particles_t* particles, const emitter_t* emitter, int count);
+
+// moves everything along by dt seconds & gets rid of the dead ones
+void V_UpdateParticles(particles_t* particles, float dt);
+
+// draws every particle in one go, space (0, 0) has its bottom left corner
+// at originX, originY & each space is scale pixels across
+void V_DrawParticles(particles_t* particles, struct SDL_Renderer* renderer, float originX, float originY, float scale);
+
+int V_CountParticles(particles_t* particles);
+
+#endif  // TEBRIS_V_PARTICLES_H
@@ -0,0 +1,328 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "v_textcache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "s_alloc.h"
+
+#define EMPTY_SLOT (-1)
+#define NO_ENTRY (-1)
+
+typedef struct textentry_s
+{
+    uint32_t hash;
+    int fontSize;
+    char* text;
+
+    SDL_Texture* texture;
+    int width;
+    int height;
+    size_t bytes;
+
+    // least recently used list, newest first
+    int prev;
+    int next;
+} textentry_t;
+
+struct textcache_s
+{
+    alloc_t* alloc;
+
+    int maxEntries;
+    size_t maxBytes;
+
+    // entries never move, so the list & slots can point at them by index
+    textentry_t* entries;
+    // unused entries, chained through next
+    int freeEntries;
+
+    // open addressing with linear probing, each slot holds an entry index
+    int* slots;
+    uint32_t slotMask;
+
+    int newest;
+    int oldest;
+
+    textcachestats_t stats;
+};
+
+// fnv-1a, with the font size mixed in
+static uint32_t HashText(const char* text, int fontSize)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* c = text; *c; c++)
+    {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+
+    hash ^= (uint32_t)fontSize;
+    hash *= 16777619u;
+
+    return hash;
+}
+
+textcache_t* V_CreateTextCache(struct alloc_s* alloc, int maxEntries, size_t maxBytes)
+{
+    if (maxEntries < 1)
+        maxEntries = 1;
+
+    textcache_t* cache = S_Allocate(alloc, sizeof(textcache_t));
+    if (!cache)
+    {
+        fputs("Failed to allocate memory for text cache\n", stderr);
+        return NULL;
+    }
+
+    cache->alloc = alloc;
+    cache->maxEntries = maxEntries;
+    cache->maxBytes = maxBytes;
+
+    // at most half full keeps probes short
+    uint32_t numSlots = 1;
+    while (numSlots < (uint32_t)maxEntries * 2)
+    {
+        numSlots <<= 1;
+    }
+    cache->slotMask = numSlots - 1;
+
+    cache->entries = S_Allocate(alloc, sizeof(textentry_t) * maxEntries);
+    cache->slots = S_Allocate(alloc, sizeof(int) * numSlots);
+    if (!cache->entries || !cache->slots)
+    {
+        fputs("Failed to allocate memory for text cache table\n", stderr);
+        V_DestroyTextCache(cache);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < numSlots; i++)
+    {
+        cache->slots[i] = EMPTY_SLOT;
+    }
+
+    for (int i = 0; i < maxEntries; i++)
+    {
+        cache->entries[i].next = i + 1 < maxEntries ? i + 1 : NO_ENTRY;
+    }
+    cache->freeEntries = 0;
+
+    cache->newest = NO_ENTRY;
+    cache->oldest = NO_ENTRY;
+
+    return cache;
+}
+
+void V_DestroyTextCache(textcache_t* cache)
+{
+    if (cache->entries && cache->slots)
+    {
+        const textcachestats_t* stats = &cache->stats;
+        printf("Text cache: %llu hits, %llu misses, %llu evictions\n",
+               (unsigned long long)stats->hits, (unsigned long long)stats->misses, (unsigned long long)stats->evictions);
+
+        V_ClearTextCache(cache);
+    }
+
+    if (cache->slots)
+        S_Free(cache->alloc, cache->slots);
+
+    if (cache->entries)
+        S_Free(cache->alloc, cache->entries);
+
+    S_Free(cache->alloc, cache);
+}
+
+static void Unlink(textcache_t* cache, int index)
+{
+    textentry_t* entry = &cache->entries[index];
+
+    if (entry->prev != NO_ENTRY)
+        cache->entries[entry->prev].next = entry->next;
+    else
+        cache->newest = entry->next;
+
+    if (entry->next != NO_ENTRY)
+        cache->entries[entry->next].prev = entry->prev;
+    else
+        cache->oldest = entry->prev;
+}
+
+static void PushNewest(textcache_t* cache, int index)
+{
+    textentry_t* entry = &cache->entries[index];
+
+    entry->prev = NO_ENTRY;
+    entry->next = cache->newest;
+
+    if (cache->newest != NO_ENTRY)
+        cache->entries[cache->newest].prev = index;
+    else
+        cache->oldest = index;
+
+    cache->newest = index;
+}
+
+// slot holding the entry, or the empty slot it would go in
+static uint32_t FindSlot(textcache_t* cache, uint32_t hash, const char* text, int fontSize)
+{
+    uint32_t slot = hash & cache->slotMask;
+
+    while (cache->slots[slot] != EMPTY_SLOT)
+    {
+        const textentry_t* entry = &cache->entries[cache->slots[slot]];
+        if (entry->hash == hash && entry->fontSize == fontSize && strcmp(entry->text, text) == 0)
+        {
+            break;
+        }
+
+        slot = (slot + 1) & cache->slotMask;
+    }
+
+    return slot;
+}
+
+// backward shift deletion, so lookups never need tombstones
+static void RemoveSlot(textcache_t* cache, uint32_t slot)
+{
+    uint32_t hole = slot;
+    uint32_t next = (slot + 1) & cache->slotMask;
+
+    while (cache->slots[next] != EMPTY_SLOT)
+    {
+        const uint32_t home = cache->entries[cache->slots[next]].hash & cache->slotMask;
+
+        // move it back if the hole is between where it wants to be & where
+        // it ended up
+        if (((next - home) & cache->slotMask) >= ((next - hole) & cache->slotMask))
+        {
+            cache->slots[hole] = cache->slots[next];
+            hole = next;
+        }
+
+        next = (next + 1) & cache->slotMask;
+    }
+
+    cache->slots[hole] = EMPTY_SLOT;
+}
+
+static void RemoveEntry(textcache_t* cache, int index)
+{
+    textentry_t* entry = &cache->entries[index];
+
+    RemoveSlot(cache, FindSlot(cache, entry->hash, entry->text, entry->fontSize));
+    Unlink(cache, index);
+
+    SDL_DestroyTexture(entry->texture);
+    S_Free(cache->alloc, entry->text);
+
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->bytes;
+
+    entry->next = cache->freeEntries;
+    cache->freeEntries = index;
+}
+
+SDL_Texture* V_FindText(textcache_t* cache, const char* text, int fontSize, int* width, int* height)
+{
+    const uint32_t hash = HashText(text, fontSize);
+    const int index = cache->slots[FindSlot(cache, hash, text, fontSize)];
+
+    if (index == EMPTY_SLOT)
+    {
+        cache->stats.misses++;
+        return NULL;
+    }
+
+    cache->stats.hits++;
+
+    Unlink(cache, index);
+    PushNewest(cache, index);
+
+    const textentry_t* entry = &cache->entries[index];
+    *width = entry->width;
+    *height = entry->height;
+    return entry->texture;
+}
+
+void V_AddText(textcache_t* cache, const char* text, int fontSize, SDL_Texture* texture, int width, int height)
+{
+    const uint32_t hash = HashText(text, fontSize);
+    const size_t bytes = (size_t)width * height * 4;
+
+    // already there, nothing to do
+    if (cache->slots[FindSlot(cache, hash, text, fontSize)] != EMPTY_SLOT)
+    {
+        SDL_DestroyTexture(texture);
+        return;
+    }
+
+    // make room, something too big for the budget still gets in on its own
+    while (cache->oldest != NO_ENTRY &&
+           (cache->stats.entries >= cache->maxEntries || cache->stats.bytes + bytes > cache->maxBytes))
+    {
+        RemoveEntry(cache, cache->oldest);
+        cache->stats.evictions++;
+    }
+
+    const size_t length = strlen(text);
+    char* copy = S_Allocate(cache->alloc, length + 1);
+    if (!copy)
+    {
+        fputs("Failed to allocate memory for cached text\n", stderr);
+        SDL_DestroyTexture(texture);
+        return;
+    }
+    memcpy(copy, text, length);
+
+    const int index = cache->freeEntries;
+    textentry_t* entry = &cache->entries[index];
+    cache->freeEntries = entry->next;
+
+    entry->hash = hash;
+    entry->fontSize = fontSize;
+    entry->text = copy;
+    entry->texture = texture;
+    entry->width = width;
+    entry->height = height;
+    entry->bytes = bytes;
+
+    cache->slots[FindSlot(cache, hash, text, fontSize)] = index;
+    PushNewest(cache, index);
+
+    cache->stats.entries++;
+    cache->stats.bytes += bytes;
+}
+
+void V_ClearTextCache(textcache_t* cache)
+{
+    while (cache->oldest != NO_ENTRY)
+    {
+        RemoveEntry(cache, cache->oldest);
+    }
+}
+
+void V_GetTextCacheStats(textcache_t* cache, textcachestats_t* stats)
+{
+    *stats = cache->stats;
+}
@@ -0,0 +1,57 @@
+/*
+    Copyright (C) 2025 Ryan Rhee
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEBRIS_V_TEXTCACHE_H
+#define TEBRIS_V_TEXTCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct alloc_s;
+struct SDL_Texture;
+
+// rendered strings, looked up by text & font size, once there are too
+// many or they take up too much memory the least recently used go
+typedef struct textcache_s textcache_t;
+
+typedef struct textcachestats_s
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+
+    int entries;
+    // assuming four bytes a pixel
+    size_t bytes;
+} textcachestats_t;
+
+textcache_t* V_CreateTextCache(struct alloc_s* alloc, int maxEntries, size_t maxBytes);
+
+// destroys every texture still in it
+void V_DestroyTextCache(textcache_t* cache);
+
+// NULL if it isn't there
+struct SDL_Texture* V_FindText(textcache_t* cache, const char* text, int fontSize, int* width, int* height);
+
+// the cache owns the texture from here on
+void V_AddText(textcache_t* cache, const char* text, int fontSize, struct SDL_Texture* texture, int width, int height);
+
+void V_ClearTextCache(textcache_t* cache);
+
+void V_GetTextCacheStats(textcache_t* cache, textcachestats_t* stats);
+
+#endif  // TEBRIS_V_TEXTCACHE_H
@@ -20,28 +20,181 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
 #if defined(__unix__)
 #include <dirent.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #endif
 
 #include "SDL.h"
+#if defined(BLOCKGAM_USE_TTF)
 #include "SDL_ttf.h"
+#endif
 
 #include "g_board.h"
 #include "g_piece.h"
 #include "m_menu.h"
 #include "s_alloc.h"
+#include "v_capture.h"
+#include "v_pacer.h"
+#include "v_particles.h"
+#include "v_textcache.h"
+
+#if defined(BLOCKGAM_BAKED_FONT)
+#include "v_bakedfont.h"
+// made when building, see bakefont.c
+#include "baked_font.h"
+#elif !defined(BLOCKGAM_USE_TTF)
+#error "Text needs either the baked font or SDL_ttf"
+#endif
 
-typedef struct internal_texture_s
+// board spaces from first to last, both included
+typedef struct cellrange_s
 {
-    char* name;
-    SDL_Texture* handle;
-    int width;
-    int height;
-} internal_texture_t;
+    int firstX;
+    int lastX;
+    int firstY;
+    int lastY;
+} cellrange_t;
+
+// every space the board cache holds, borders included
+static const cellrange_t allCells = { -1, GRID_WIDTH, -1, GRID_HEIGHT };
+
+// where everything goes on screen, only worked out when the size changes
+// or the camera moves
+typedef struct layout_s
+{
+    // size of one board space with the camera all the way out
+    int baseCellSize;
+    // where the whole board goes with the camera all the way out, the board
+    // never gets drawn outside of it
+    SDL_Rect viewport;
+
+    // size of one board space
+    int cellSize;
+    // top left corner of space (0, 0)
+    int boardX;
+    int boardY;
+
+    // spaces at least partly inside the viewport
+    cellrange_t visible;
+    uint64_t visibleRows;
+
+    int minimapX;
+    int minimapY;
+    int minimapCellSize;
+    // part of the minimap the viewport shows
+    SDL_Rect minimapView;
+
+    // boards side by side when there's more than one, sizes are in spaces
+    // & each board takes GRID_WIDTH + 2 by GRID_HEIGHT + 2 with its border
+    int wallColumns;
+    int wallCellSize;
+    // top left corner of the first board's border
+    int wallX;
+    int wallY;
+
+    // bevel around the face of a block
+    int bevelInset;
+
+    // text next to the board
+    int sideTextX;
+    int scoreY;
+    int finesseY;
+    int levelY;
+
+    int failX;
+    int failY;
+
+    int menuX;
+    int menuY;
+    int menuRowHeight;
+    int menuMarkerX;
+    int menuMarkerY;
+    int menuMarkerSize;
+} layout_t;
+
+typedef enum boardrenderer_e
+{
+    // board blocks batched into geometry & cached in a render target
+    BOARDRENDERER_GEOMETRY,
+    // board drawn on the cpu & uploaded into a streaming texture
+    BOARDRENDERER_FRAMEBUFFER,
+} boardrenderer_t;
+
+typedef struct camera_s
+{
+    // whole steps, so blocks stay lined up with pixels
+    int zoom;
+    // board position in the middle of the viewport, in spaces going up
+    float x;
+    float y;
+    // keep the current piece in the middle
+    bool follow;
+} camera_t;
+
+#define MAX_ZOOM (4)
+
+// spaces between boards on the wall
+#define WALL_GAP (1)
+
+// size fonts get opened at, before anything's been fit to the window
+#define DEFAULT_FONT_SIZE (28)
+
+// font sizes get rounded down to this, so a window being dragged around
+// only goes through a few of them
+#define FONT_SIZE_STEP (4)
+
+// sizes kept open at once, least recently used gets closed first
+#define FONT_SIZES (4)
+
+// how long the window has to stay the same size before everything gets
+// redone for it
+#define RESIZE_SETTLE_MS (150)
+
+// BLOCKGAM_TEXT_CACHE=entries,kilobytes overrides these
+#define TEXT_CACHE_ENTRIES (64)
+#define TEXT_CACHE_KILOBYTES (4096)
+
+// printable ascii gets drawn from the glyph atlas, anything else falls back
+// to rendering the whole string
+#define FIRST_GLYPH (32)
+#define LAST_GLYPH (126)
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+#define GLYPH_ATLAS_COLUMNS (16)
+
+#if defined(BLOCKGAM_BAKED_FONT) && (BAKED_FIRST_GLYPH != FIRST_GLYPH || BAKED_NUM_GLYPHS != NUM_GLYPHS)
+#error "The baked font has different glyphs to the atlas"
+#endif
+
+// more than fits on the screen at once
+#define MAX_TEXT_QUADS (512)
+
+#if defined(BLOCKGAM_USE_TTF)
+typedef struct fontsize_s
+{
+    TTF_Font* font;
+    int size;
+    uint64_t lastUsed;
+} fontsize_t;
+#endif
+
+typedef struct glyph_s
+{
+    // where it is in the atlas
+    SDL_Rect source;
+    // how far along the next one goes
+    int advance;
+} glyph_t;
 
 struct video_s
 {
@@ -50,17 +203,199 @@ struct video_s
     SDL_Window* window;
     SDL_Renderer* renderer;
 
-    TTF_Font* font;
+    pacer_t* pacer;
+
+    // NULL unless recording
+    capture_t* capture;
 
+    // line clear & landing effects, in board spaces
+    particles_t* particles;
+    uint64_t lastParticleUpdate;
+
+#if defined(BLOCKGAM_USE_TTF)
+    // with the baked font this only gets opened once something needs
+    // drawing that the atlas doesn't have
+    // the file's mapped once & every size gets opened from it
+    void* fontData;
+    size_t fontDataSize;
+    fontsize_t fontSizes[FONT_SIZES];
+    uint64_t fontUses;
+    bool fontTried;
+#endif
+
+    // text gets ready on its own thread while the window shows a loading
+    // screen, the loader fills in loadedAtlas & loadedGlyphs then sets
+    // loaded, the main thread uploads them
+    bool loading;
+    SDL_Thread* loader;
+    SDL_atomic_t loaded;
+    SDL_Surface* loadedAtlas;
+    glyph_t loadedGlyphs[NUM_GLYPHS];
+    // the window changed size while loading, so the font size is stale
+    bool loadedSizeStale;
+
+    // when V_Init started, for timing startup
+    uint64_t startCounter;
+
+    // dragging the window edge sends lots of resizes, they wait until the
+    // size stops changing & what's drawn gets scaled to fit until then
+    bool resizePending;
+    uint64_t resizeTime;
+
+    // size everything gets drawn at, the window size unless there's a scene
     int width;
     int height;
 
+    int windowWidth;
+    int windowHeight;
+
+    // fixed size texture everything gets drawn into first, then scaled up
+    // to sceneRect in the window
+    SDL_Texture* scene;
+    SDL_Rect sceneRect;
+
+    layout_t layout;
+    camera_t camera;
+
+    // more than one lays the boards out in a wall & turns off the camera
+    int boardCount;
+
     bool visible;
 
-    internal_texture_t* textureCache;
-    size_t textureCacheLength;
+    int fontSize;
+
+    // strings the glyph atlas can't do
+    textcache_t* textCache;
+
+    // every printable ascii glyph at the current font size
+    SDL_Texture* glyphAtlas;
+    glyph_t glyphs[NUM_GLYPHS];
+
+    // text waiting to be drawn, goes on top of the tile batch, the indices
+    // never change
+    SDL_Vertex* textVertices;
+    int* textIndices;
+    int textQuads;
+
+    // every kind of block drawn once, at the current block size
+    SDL_Texture* tileAtlas;
+
+    // locked blocks & borders of the board, only rows that changed get redrawn
+    SDL_Texture* boardCache;
+    bool boardCacheValid;
+    // copies of the same board share an id, so swapping between them
+    // doesn't redraw everything
+    uint32_t cachedBoardId;
+    uint64_t cachedGeneration;
+    // rows that changed while out of view, drawn once they show up
+    uint64_t pendingRows;
+
+    // the board at one pixel a space, shown when zoomed in
+    SDL_Texture* minimap;
+    uint32_t minimapPixels[GRID_WIDTH * GRID_HEIGHT];
+    bool minimapValid;
+    uint32_t minimapBoardId;
+    uint64_t minimapGeneration;
+
+    // set while the board clip is on, until the board gets flushed
+    bool boardClipped;
+
+    boardrenderer_t boardRenderer;
+    // draws straight into the window surface on the cpu
+    bool softwareRenderer;
+
+    // framebuffer renderer: the tile atlas pixels, the locked blocks &
+    // borders drawn on the cpu, and the texture it all gets uploaded to
+    uint32_t* tilePixels;
+    uint32_t* boardPixels;
+    SDL_Texture* boardStream;
+    // set while the stream texture is locked, pitch is in pixels
+    uint32_t* streamPixels;
+    int streamPitch;
+    // part of the board the locked pixels cover
+    SDL_Rect streamArea;
+
+    // board blocks get collected here and drawn with one call
+    SDL_Vertex* batchVertices;
+    int* batchIndices;
+    int batchQuads;
+    int batchMaxQuads;
+};
+
+#define GREY_COLOR (25)
+
+// tiles in the atlas, the empty tile is plain black
+#define TILE_EMPTY (0)
+#define TILE_GREY (PIECETYPE_END + 1)
+#define TILE_UNKNOWN (PIECETYPE_END + 2)
+#define NUM_TILES (PIECETYPE_END + 3)
+
+static const SDL_Color tileColors[NUM_TILES] = {
+    [TILE_EMPTY] = { 0, 0, 0, 255 },
+    [1] = { 255, 0, 0, 255 },
+    [2] = { 0, 255, 0, 255 },
+    [3] = { 0, 0, 255, 255 },
+    [4] = { 255, 255, 0, 255 },
+    [5] = { 255, 128, 0, 255 },
+    [6] = { 0, 200, 255, 255 },
+    [7] = { 200, 0, 255, 255 },
+    [TILE_GREY] = { 200, 200, 200, 255 },
+    [TILE_UNKNOWN] = { 255, 255, 255, 255 },
 };
 
+// the play space background, every block and border block of the board
+// and the falling piece
+#define BATCH_START_QUADS (1 + GRID_WIDTH * GRID_HEIGHT + (GRID_WIDTH + 2) + 2 * (GRID_HEIGHT + 1) + PIECE_CELLS)
+
+// hard cap, a bot clearing lines as fast as it can stays well under it
+#define MAX_PARTICLES (8192)
+// per block of a cleared row
+#define BURST_PARTICLES (24)
+// per block of a piece landing
+#define DUST_PARTICLES (6)
+
+// blocks on the loading screen, lit up one after the other
+#define LOADING_BLOCKS (3)
+#define LOADING_STEP_MS (250)
+
+#if defined(BLOCKGAM_USE_TTF)
+// a few sizes stay open, so going back to one doesn't need the font
+// opened again, the file has to be mapped already
+static TTF_Font* FontAtSize(video_t* video, int size)
+{
+    fontsize_t* slot = NULL;
+    for (int i = 0; i < FONT_SIZES; i++)
+    {
+        fontsize_t* fontSize = &video->fontSizes[i];
+        if (fontSize->font && fontSize->size == size)
+        {
+            fontSize->lastUsed = ++video->fontUses;
+            return fontSize->font;
+        }
+
+        // empty ones first, then the one that's gone longest unused
+        if (!slot || (slot->font && (!fontSize->font || fontSize->lastUsed < slot->lastUsed)))
+        {
+            slot = fontSize;
+        }
+    }
+
+    if (slot->font)
+        TTF_CloseFont(slot->font);
+
+    SDL_RWops* rw = SDL_RWFromConstMem(video->fontData, (int)video->fontDataSize);
+    slot->font = rw ? TTF_OpenFontRW(rw, 1, size) : NULL;
+    slot->size = size;
+    slot->lastUsed = ++video->fontUses;
+
+    if (!slot->font)
+    {
+        printf("Couldn't open font at %d: %s\n", size, TTF_GetError());
+    }
+
+    return slot->font;
+}
+
 #if defined(__unix__)
 static bool SubstrPresent(const char* main, size_t mainLen, const char* sub, size_t subLen)
 {
@@ -116,17 +451,131 @@ static bool IsBadFont(const char* fontName, size_t fontNameLen)
     return false;
 }
 
-static TTF_Font* SearchDirForFont(alloc_t* alloc, const char* path, const size_t pathLen)
+#if defined(__linux__)
+// longest font path that gets remembered
+#define FONT_PATH_MAX (4096)
+
+// $XDG_CACHE_HOME/blockgam/font, or ~/.cache/blockgam/font, makes the
+// directories on the way if making is set
+static bool GetFontCachePath(char* cachePath, size_t size, bool making)
+{
+    const char* cacheHome = SDL_getenv("XDG_CACHE_HOME");
+    const char* home = SDL_getenv("HOME");
+
+    char dir[FONT_PATH_MAX];
+    if (cacheHome && cacheHome[0] == '/')
+        snprintf(dir, sizeof dir, "%s", cacheHome);
+    else if (home)
+        snprintf(dir, sizeof dir, "%s/.cache", home);
+    else
+        return false;
+
+    if (making)
+        mkdir(dir, 0755);
+
+    const size_t dirLen = strlen(dir);
+    snprintf(dir + dirLen, sizeof dir - dirLen, "/blockgam");
+
+    if (making)
+        mkdir(dir, 0755);
+
+    return (size_t)snprintf(cachePath, size, "%s/font", dir) < size;
+}
+
+static bool MapFontFile(video_t* video, const char* path);
+
+// the cache holds the font path, then its mtime & size, if the file's
+// still the same then it's still good
+static bool OpenCachedFont(video_t* video)
+{
+    char cachePath[FONT_PATH_MAX];
+    if (!GetFontCachePath(cachePath, sizeof cachePath, false))
+        return false;
+
+    FILE* file = fopen(cachePath, "r");
+    if (!file)
+        return false;
+
+    char fontPath[FONT_PATH_MAX];
+    long long mtime, size;
+    const bool read = fgets(fontPath, sizeof fontPath, file) != NULL &&
+                      fscanf(file, "%lld %lld", &mtime, &size) == 2;
+    fclose(file);
+
+    if (!read)
+        return false;
+
+    fontPath[strcspn(fontPath, "\n")] = '\0';
+
+    struct stat buf;
+    if (stat(fontPath, &buf) == -1 || (long long)buf.st_mtime != mtime || (long long)buf.st_size != size)
+        return false;
+
+    return MapFontFile(video, fontPath);
+}
+
+static void CacheFontPath(const char* fontPath)
+{
+    struct stat buf;
+    if (stat(fontPath, &buf) == -1)
+        return;
+
+    char cachePath[FONT_PATH_MAX];
+    if (!GetFontCachePath(cachePath, sizeof cachePath, true))
+        return;
+
+    FILE* file = fopen(cachePath, "w");
+    if (!file)
+        return;
+
+    fprintf(file, "%s\n%lld %lld\n", fontPath, (long long)buf.st_mtime, (long long)buf.st_size);
+    fclose(file);
+}
+#endif
+
+// opening it at the current size checks it's really a font
+static bool MapFontFile(video_t* video, const char* path)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat buf;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &buf) == 0 && buf.st_size > 0 && buf.st_size <= INT_MAX)
+        data = mmap(NULL, (size_t)buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    video->fontData = data;
+    video->fontDataSize = (size_t)buf.st_size;
+
+    if (!FontAtSize(video, video->fontSize))
+    {
+        munmap(data, video->fontDataSize);
+        video->fontData = NULL;
+        video->fontDataSize = 0;
+        return false;
+    }
+
+    printf("Font found: %s\n", path);
+    return true;
+}
+
+// remember is set to save whatever gets found for next time
+static bool SearchDirForFont(video_t* video, const char* path, const size_t pathLen, bool remember)
 {
     DIR* fontDir;
     struct dirent* fontEnt;
     const char* ext;
-    TTF_Font* font;
+    bool found;
 
     if ((fontDir = opendir(path)) == NULL)
-        return NULL;
+        return false;
 
-    font = NULL;
+    found = false;
     while ((fontEnt = readdir(fontDir)) != NULL)
     {
         ext = strrchr(fontEnt->d_name, '.');
@@ -141,7 +590,7 @@ static TTF_Font* SearchDirForFont(alloc_t* alloc, const char* path, const size_t
             continue;
 
         const size_t fullpathLen = fileLen + pathLen + 2;
-        char* fullpath = S_Allocate(alloc, sizeof(char) * fullpathLen);
+        char* fullpath = S_Allocate(video->alloc, sizeof(char) * fullpathLen);
 
         if (!fullpath)
             continue;
@@ -151,37 +600,48 @@ static TTF_Font* SearchDirForFont(alloc_t* alloc, const char* path, const size_t
         fullpath[pathLen] = '/';
         memcpy(fullpath + pathLen + 1, fontEnt->d_name, fileLen);
 
-        font = TTF_OpenFont(fullpath, 28);
+        found = MapFontFile(video, fullpath);
 
-        if (font != NULL)
+        if (found)
         {
-            printf("Font found: %s\n", fullpath);
+#if defined(__linux__)
+            if (remember)
+                CacheFontPath(fullpath);
+#else
+            (void)remember;
+#endif
         }
 
-        S_Free(alloc, fullpath);
+        S_Free(video->alloc, fullpath);
 
-        if (font != NULL)
+        if (found)
         {
             break;
         }
     }
 
     closedir(fontDir);
-    return font;
+    return found;
 }
 #endif
 
-static TTF_Font* ChooseFont(alloc_t* alloc)
+static bool ChooseFont(video_t* video)
 {
-    TTF_Font* foundFont = NULL;
-#if defined BLOCKGAM_FONT_DIR
-    if ((foundFont = SearchDirForFont(alloc, BLOCKGAM_FONT_DIR, strlen(BLOCKGAM_FONT_DIR))) != NULL)
+    bool foundFont = false;
+#if defined(__unix__) && defined(BLOCKGAM_FONT_DIR)
+    if ((foundFont = SearchDirForFont(video, BLOCKGAM_FONT_DIR, strlen(BLOCKGAM_FONT_DIR), false)))
     {
         return foundFont;
     }
 #endif
 
 #if defined(__linux__)
+    // saves going through every font on the system again
+    if ((foundFont = OpenCachedFont(video)))
+    {
+        return foundFont;
+    }
+
     static const char* directories[] = {
         "/usr/share/fonts",
     };
@@ -203,7 +663,7 @@ static TTF_Font* ChooseFont(alloc_t* alloc)
             const size_t nameLen = strlen(ent->d_name);
             const size_t dirLen = strlen(directories[i]);
             const size_t fullpathLen = nameLen + dirLen + 1 + 1;
-            char* fullpath = S_Allocate(alloc, sizeof(char) * fullpathLen);
+            char* fullpath = S_Allocate(video->alloc, sizeof(char) * fullpathLen);
 
             if (fullpath == NULL)
                 continue;
@@ -216,15 +676,15 @@ static TTF_Font* ChooseFont(alloc_t* alloc)
             if (stat(fullpath, &buf) == -1 ||
                 !S_ISDIR(buf.st_mode))
             {
-                S_Free(alloc, fullpath);
+                S_Free(video->alloc, fullpath);
                 continue;
             }
 
-            foundFont = SearchDirForFont(alloc, fullpath, fullpathLen - 1);
+            foundFont = SearchDirForFont(video, fullpath, fullpathLen - 1, true);
 
-            S_Free(alloc, fullpath);
+            S_Free(video->alloc, fullpath);
 
-            if (foundFont != NULL)
+            if (foundFont)
                 break;
         }
         closedir(dir);
@@ -234,360 +694,2058 @@ static TTF_Font* ChooseFont(alloc_t* alloc)
     return foundFont;
 }
 
-video_t* V_Init(alloc_t* alloc, int width, int height)
+// only tries once, if there's no font the first time there won't be one
+// the next time either
+static bool OpenFont(video_t* video)
 {
-    video_t* video = S_Allocate(alloc, sizeof(video_t));
-
-    video->alloc = alloc;
-
-    // who needs error checking
-    SDL_InitSubSystem(SDL_INIT_VIDEO);
-
-    video->window = SDL_CreateWindow("blockgam", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
-
-    video->renderer = SDL_CreateRenderer(video->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (video->fontData || video->fontTried)
+    {
+        return video->fontData != NULL;
+    }
+    video->fontTried = true;
 
     if (TTF_Init() == -1)
     {
         fputs("Failed to initialize SDL_ttf\n", stderr);
-        return NULL;
+        return false;
     }
 
-    if ((video->font = ChooseFont(video->alloc)) == NULL)
+    if (!ChooseFont(video))
     {
         fputs("Failed to open font file\n", stderr);
-        return NULL;
+        return false;
     }
 
-    video->width = width;
-    video->height = height;
-
-    video->visible = true;
-
-    video->textureCache = NULL;
-    video->textureCacheLength = 0;
-
-    return video;
+    return true;
 }
+#endif
 
-void V_Clear(video_t* video, int r, int g, int b)
+#define ALL_ROWS ((UINT64_C(1) << GRID_HEIGHT) - 1)
+
+inline static float ClampFloat(float f, float min, float max)
 {
-    SDL_SetRenderDrawColor(video->renderer, r, g, b, 255);
-    SDL_RenderClear(video->renderer);
+    if (f < min)
+        return min;
+    if (f > max)
+        return max;
+    return f;
 }
 
-void V_SetVisibility(video_t* video, bool visible)
+inline static int ClampInt(int i, int min, int max)
 {
-    video->visible = visible;
+    if (i < min)
+        return min;
+    if (i > max)
+        return max;
+    return i;
 }
 
-static void ClearTextureCache(video_t* video)
+// works out the board position & size from the camera, all the way out
+// this is the same as not having a camera at all
+static void ApplyCamera(video_t* video)
 {
-    for (size_t i = 0; i < video->textureCacheLength; i++)
+    layout_t* layout = &video->layout;
+    camera_t* camera = &video->camera;
+    const SDL_Rect* view = &layout->viewport;
+
+    layout->cellSize = layout->baseCellSize * camera->zoom;
+    layout->bevelInset = layout->cellSize * 0.2 / 2;
+
+    // don't let the view go past the borders
+    const float halfWidth = (float)view->w / (2 * layout->cellSize);
+    const float halfHeight = (float)view->h / (2 * layout->cellSize);
+    camera->x = ClampFloat(camera->x, -1 + halfWidth, GRID_WIDTH + 1 - halfWidth);
+    camera->y = ClampFloat(camera->y, -1 + halfHeight, GRID_HEIGHT + 1 - halfHeight);
+
+    layout->boardX = view->x + view->w / 2 - (int)(camera->x * layout->cellSize);
+    layout->boardY = view->y + view->h / 2 - layout->cellSize + (int)(camera->y * layout->cellSize);
+
+    // everything is at least -1 here, so adding 1 makes the casts round down
+    cellrange_t* visible = &layout->visible;
+    visible->firstX = ClampInt((int)(camera->x - halfWidth + 1) - 1, -1, GRID_WIDTH);
+    visible->lastX = ClampInt((int)(camera->x + halfWidth + 1) - 1, -1, GRID_WIDTH);
+    visible->firstY = ClampInt((int)(camera->y - halfHeight + 1) - 1, -1, GRID_HEIGHT);
+    visible->lastY = ClampInt((int)(camera->y + halfHeight + 1) - 1, -1, GRID_HEIGHT);
+
+    layout->visibleRows = 0;
+    for (int y = ClampInt(visible->firstY, 0, GRID_HEIGHT); y <= visible->lastY && y < GRID_HEIGHT; y++)
     {
-        SDL_DestroyTexture(video->textureCache[i].handle);
-        S_Free(video->alloc, video->textureCache[i].name);
+        layout->visibleRows |= UINT64_C(1) << y;
     }
-    S_Free(video->alloc, video->textureCache);
 
-    video->textureCache = NULL;
-    video->textureCacheLength = 0;
+    const int mini = layout->minimapCellSize;
+    layout->minimapView = (SDL_Rect){
+        .x = layout->minimapX + (int)((camera->x - halfWidth) * mini),
+        .y = layout->minimapY + (int)((GRID_HEIGHT - camera->y - halfHeight) * mini),
+        .w = (int)(halfWidth * 2 * mini),
+        .h = (int)(halfHeight * 2 * mini)
+    };
 }
 
-static internal_texture_t* GetCachedTexture(video_t* video, const char* text)
+// fit the boards to the right of the side text, trying every number of
+// columns & keeping whichever gives the biggest boards
+static void LayoutWall(video_t* video)
 {
-    for (size_t i = 0; i < video->textureCacheLength; i++)
+    layout_t* layout = &video->layout;
+    const int count = video->boardCount;
+
+    const int slotWidth = GRID_WIDTH + 2 + WALL_GAP;
+    const int slotHeight = GRID_HEIGHT + 2 + WALL_GAP;
+
+    const SDL_Rect area = {
+        .x = video->width * 2 / 5,
+        .y = video->height / 16,
+        .w = video->width * 3 / 5 - video->height / 16,
+        .h = video->height * 7 / 8
+    };
+
+    layout->wallColumns = 1;
+    layout->wallCellSize = 0;
+    for (int columns = 1; columns <= count; columns++)
     {
-        if (strcmp(video->textureCache[i].name, text) == 0)
+        const int rows = (count + columns - 1) / columns;
+        const int fitWidth = area.w / (columns * slotWidth - WALL_GAP);
+        const int fitHeight = area.h / (rows * slotHeight - WALL_GAP);
+        const int cellSize = fitWidth < fitHeight ? fitWidth : fitHeight;
+
+        if (cellSize > layout->wallCellSize)
         {
-            return &video->textureCache[i];
+            layout->wallCellSize = cellSize;
+            layout->wallColumns = columns;
         }
     }
 
-    const size_t newTextureNum = video->textureCacheLength++;
-    video->textureCache = S_Reallocate(video->alloc, video->textureCache, sizeof(internal_texture_t) * video->textureCacheLength);
+    if (layout->wallCellSize < 1)
+        layout->wallCellSize = 1;
 
-    SDL_Color textColor = { 255, 255, 255, 255 };
-    SDL_Surface* surface = TTF_RenderUTF8_Solid(video->font, text, textColor);
-    if (!surface)
-    {
-        printf("Couldn't render text \"%s\": %s", text, SDL_GetError());
-        return NULL;
-    }
+    const int rows = (count + layout->wallColumns - 1) / layout->wallColumns;
+    const int width = (layout->wallColumns * slotWidth - WALL_GAP) * layout->wallCellSize;
+    const int height = (rows * slotHeight - WALL_GAP) * layout->wallCellSize;
 
-    internal_texture_t* texture = video->textureCache + newTextureNum;
+    layout->wallX = area.x + (area.w - width) / 2;
+    layout->wallY = area.y + (area.h - height) / 2;
+}
 
-    size_t nameLength = strlen(text);
-    texture->name = S_Allocate(video->alloc, nameLength + 1);
-    memcpy(texture->name, text, nameLength);
+static void CalculateLayout(video_t* video)
+{
+    layout_t* layout = &video->layout;
 
-    texture->handle = SDL_CreateTextureFromSurface(video->renderer, surface);
-    if (!texture->handle)
-    {
-        printf("Failed to convert SDL_Surface to SDL_Texture: %s", SDL_GetError());
-    }
+    layout->baseCellSize = video->height / 40;
+    if (layout->baseCellSize < 1)
+        layout->baseCellSize = 1;
 
-    texture->width = surface->w;
-    texture->height = surface->h;
+    const int cellSize = layout->baseCellSize;
+    const int boardWidth = cellSize * (GRID_WIDTH + 2);
+    const int boardHeight = cellSize * (GRID_HEIGHT + 2);
 
-    SDL_FreeSurface(surface);
+    // where the board goes when it isn't zoomed in
+    const int boardX = (video->width - boardWidth) / 2;
+    const int boardY = video->height - video->height / 8;
 
-    return texture;
-}
+    layout->viewport = (SDL_Rect){
+        .x = boardX - cellSize,
+        .y = boardY - GRID_HEIGHT * cellSize,
+        .w = boardWidth,
+        .h = boardHeight
+    };
 
-static void DrawText(video_t* video, int x, int y, const char* text)
-{
-    internal_texture_t* texture = GetCachedTexture(video, text);
-    if (!texture || !texture->handle)
-        return;
+    layout->minimapCellSize = cellSize / 3;
+    if (layout->minimapCellSize < 1)
+        layout->minimapCellSize = 1;
+    layout->minimapX = layout->viewport.x + layout->viewport.w + cellSize;
+    layout->minimapY = layout->viewport.y + cellSize;
 
-    SDL_Rect rect = {
-        .x = x,
-        .y = y,
-        .w = texture->width,
-        .h = texture->height
-    };
+    layout->sideTextX = (video->width - boardWidth) / 4;
+    layout->scoreY = (video->height + boardHeight) / 4;
+    layout->finesseY = (video->height + boardHeight * 2) / 4;
+    layout->levelY = (video->height + boardHeight * 3) / 4;
 
-    SDL_RenderCopy(video->renderer, texture->handle, NULL, &rect);
-}
+    layout->failX = video->width / 3;
+    layout->failY = video->height / 2;
 
-void V_DrawMenu(video_t* video, menu_t* menu)
-{
-    menulist_t* list = M_GetList(menu);
-    if (!list)
-    {
-        return;
-    }
+    layout->menuX = 100;
+    layout->menuY = 100;
+    layout->menuRowHeight = 75;
+    layout->menuMarkerX = 50;
+    layout->menuMarkerY = 105;
+    layout->menuMarkerSize = 8;
 
-    for (size_t i = 0; i < list->numItems; i++)
+    if (video->boardCount > 1)
     {
-        SDL_SetRenderDrawColor(video->renderer, 255, 0, 0, 1);
-        DrawText(video, 100, (int)i * 75 + 100, list->items[i]->label);
+        LayoutWall(video);
     }
 
-    const size_t currItem = M_GetCurrentItem(menu);
-    SDL_Rect selectRect = {
-        .x = 50,
-        .y = (int)currItem * 75 + 105,
-        .w = 8,
-        .h = 8
-    };
-    SDL_RenderFillRect(video->renderer, &selectRect);
+    ApplyCamera(video);
 }
 
-inline static int CalculatePixelSize(video_t* video)
+inline static int TileIndex(uint8_t c)
 {
-    return video->height / 40;
-}
-
-#define GREY_COLOR (25)
-
-inline static void DrawRectBoardSpace(video_t* video, int x, int y, uint8_t c)
-{
-    SDL_Color color = { .a = 1 };
-    switch (c)
-    {
-    case 0:
-        color.r = 0;
-        color.g = 0;
-        color.b = 0;
-        break;
-    case 1:
-        color.r = 255;
-        color.g = 0;
-        color.b = 0;
-        break;
-    case 2:
-        color.r = 0;
-        color.g = 255;
-        color.b = 0;
-        break;
-    case 3:
-        color.r = 0;
-        color.g = 0;
-        color.b = 255;
-        break;
-    case 4:
-        color.r = 255;
-        color.g = 255;
-        color.b = 0;
-        break;
-    case 5:
-        color.r = 255;
-        color.g = 128;
-        color.b = 0;
-        break;
-    case 6:
-        color.r = 0;
-        color.g = 200;
-        color.b = 255;
-        break;
-    case 7:
-        color.r = 200;
-        color.g = 0;
-        color.b = 255;
-        break;
-    case GREY_COLOR:
-        color.r = 200;
-        color.g = 200;
-        color.b = 200;
-        break;
-    default:
-        color.r = 255;
-        color.g = 255;
-        color.b = 255;
-        break;
-    }
-
-    const int pixelSize = CalculatePixelSize(video);
-
-    const int startX = (video->width - (pixelSize * (GRID_WIDTH + 2))) / 2;
-    const int startY = (video->height / 8);
-
-    SDL_SetRenderDrawColor(video->renderer, color.r * 0.9, color.g * 0.9, color.b * 0.9, color.a);
+    if (c <= PIECETYPE_END)
+        return c;
 
-    SDL_Rect drect = {
-        .x = x * pixelSize + startX,
-        .y = video->height - y * pixelSize - startY,
-        .w = pixelSize,
-        .h = pixelSize
-    };
-    SDL_RenderFillRect(video->renderer, &drect);
+    if (c == GREY_COLOR)
+        return TILE_GREY;
 
-    SDL_SetRenderDrawColor(video->renderer, color.r, color.g, color.b, color.a);
-
-    const int offset = pixelSize * 0.2 / 2;
-    drect = (SDL_Rect){
-        .x = x * pixelSize + startX + offset,
-        .y = video->height - y * pixelSize - startY + offset,
-        .w = pixelSize * 0.8,
-        .h = pixelSize * 0.8
-    };
-    SDL_RenderFillRect(video->renderer, &drect);
+    return TILE_UNKNOWN;
 }
 
-void V_DrawBoard(video_t* video, board_t* board)
+inline static uint8_t Shade(uint8_t c, float amount)
 {
-    // draw play space
-    for (int x = 0; x < GRID_WIDTH; x++)
-    {
-        for (int y = 0; y < GRID_HEIGHT; y++)
-        {
-            DrawRectBoardSpace(video, x, y, G_GetBoardSpace(board, x, y));
-        }
-    }
+    const float shaded = c * amount;
+    return shaded > 255.0f ? 255 : (uint8_t)shaded;
+}
 
-    // draw bottom of playspace
-    for (int x = -1; x <= GRID_WIDTH; x++)
+// draws all the block tiles side by side into a texture, so blocks are
+// just copies out of it and can be shaded however we want for free
+static bool BuildTileAtlas(video_t* video)
+{
+    if (video->tileAtlas)
     {
-        DrawRectBoardSpace(video, x, -1, GREY_COLOR);
+        SDL_DestroyTexture(video->tileAtlas);
+        video->tileAtlas = NULL;
     }
 
-    // draw left side of playspace
-    for (int y = 0; y <= GRID_HEIGHT; y++)
-    {
-        DrawRectBoardSpace(video, -1, y, GREY_COLOR);
-    }
+    const int size = video->layout.cellSize;
 
-    // draw right side of playspace
-    for (int y = 0; y <= GRID_HEIGHT; y++)
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, size * NUM_TILES, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface)
     {
-        DrawRectBoardSpace(video, GRID_WIDTH, y, GREY_COLOR);
+        printf("Failed to create tile surface: %s\n", SDL_GetError());
+        return false;
     }
-}
-
-void V_DrawPiece(video_t* video, piece_t* piece)
-{
-    const int x = G_GetPieceX(piece);
-    const int y = G_GetPieceY(piece);
 
-    const int halfWidth = PIECE_WIDTH / 2;
-    const int halfHeight = PIECE_HEIGHT / 2;
+    const int bevel = video->layout.bevelInset;
 
-    for (int i = -halfWidth; i <= halfWidth; i++)
+    for (int tile = 0; tile < NUM_TILES; tile++)
     {
-        for (int j = -halfHeight; j <= halfHeight; j++)
+        const SDL_Color color = tileColors[tile];
+
+        for (int y = 0; y < size; y++)
         {
-            uint8_t c = G_GetPieceSpace(piece, i, j);
-            if (!c)
+            uint32_t* row = (uint32_t*)((uint8_t*)surface->pixels + y * surface->pitch) + tile * size;
+
+            for (int x = 0; x < size; x++)
             {
-                continue;
+                float amount;
+                if (x >= bevel && y >= bevel && x < size - bevel && y < size - bevel)
+                {
+                    // face, getting a little darker towards the bottom
+                    amount = 1.0f - 0.15f * y / size;
+                }
+                else if (x + y < size)
+                {
+                    // top & left edges catch the light
+                    amount = 1.2f;
+                }
+                else
+                {
+                    amount = 0.65f;
+                }
+
+                row[x] = SDL_MapRGB(surface->format, Shade(color.r, amount), Shade(color.g, amount), Shade(color.b, amount));
             }
-
-            DrawRectBoardSpace(video, x + i, y + j, c);
         }
     }
-}
 
-void V_DrawLevel(video_t* video, int level)
-{
-    static char strBuf[24];
-    snprintf(strBuf, sizeof strBuf, "Score: %d", level);
+    if (video->boardRenderer == BOARDRENDERER_FRAMEBUFFER)
+    {
+        // keep the pixels around to copy blocks out of on the cpu
+        if (video->tilePixels)
+            S_Free(video->alloc, video->tilePixels);
+
+        video->tilePixels = S_Allocate(video->alloc, sizeof(uint32_t) * NUM_TILES * size * size);
+        if (!video->tilePixels)
+        {
+            fputs("Failed to allocate memory for tile pixels\n", stderr);
+            SDL_FreeSurface(surface);
+            return false;
+        }
 
-    const int pixelSize = CalculatePixelSize(video);
-    const int x = (video->width - (pixelSize * (GRID_WIDTH + 2))) / 4;
-    const int y = (video->height + (pixelSize * (GRID_HEIGHT + 2))) / 4;
+        for (int y = 0; y < size; y++)
+        {
+            memcpy(video->tilePixels + y * NUM_TILES * size, (uint8_t*)surface->pixels + y * surface->pitch, sizeof(uint32_t) * NUM_TILES * size);
+        }
+    }
 
-    DrawText(video, x, y, strBuf);
+    video->tileAtlas = SDL_CreateTextureFromSurface(video->renderer, surface);
+    SDL_FreeSurface(surface);
 
-    int stageCalc = level / 10;
-    if (stageCalc > 25)
-        stageCalc = 25;
-    const char stage = 'A' + stageCalc;
-    snprintf(strBuf, sizeof strBuf, "Level: %c", stage);
+    if (!video->tileAtlas)
+    {
+        printf("Failed to create tile atlas: %s\n", SDL_GetError());
+        return false;
+    }
 
-    const int y2 = (video->height + (pixelSize * (GRID_HEIGHT + 2) * 3)) / 4;
+    SDL_SetTextureScaleMode(video->tileAtlas, SDL_ScaleModeNearest);
 
-    DrawText(video, x, y2, strBuf);
+    return true;
 }
 
-void V_DrawFailure(video_t* video, int level)
+// just a random quadratic formula formed from
+// (0, 4)
+// (1024, 28)
+// (2000, 48)
+// x being max size and y being font pt size
+static void SetFontSize(video_t* video)
 {
-    static char strBuf[24];
-    snprintf(strBuf, sizeof strBuf, "Final Score: %d", level);
+    float m;
+    if (video->width > video->height)
+        m = video->height;
+    else
+        m = video->width;
 
-    DrawText(video, video->width / 3, video->height / 2, strBuf);
+    const int pt = 0.0000015 * m * m + 0.025 * m + 4;
+    video->fontSize = SDL_max(pt / FONT_SIZE_STEP * FONT_SIZE_STEP, FONT_SIZE_STEP);
 }
 
-void V_Present(video_t* video)
+#if defined(BLOCKGAM_BAKED_FONT)
+// the biggest baked size that isn't bigger than the font size, so text
+// never comes out bigger than it was laid out for
+static const bakedfont_t* ChooseBakedFont(int size)
 {
-    SDL_RenderPresent(video->renderer);
+    const bakedfont_t* baked = &bakedFonts[0];
+    for (int i = 1; i < NUM_BAKED_FONTS && bakedFonts[i].size <= size; i++)
+    {
+        baked = &bakedFonts[i];
+    }
+
+    return baked;
 }
 
-void V_Quit(video_t* video)
+// the atlas is already laid out, it just needs unpacking
+static SDL_Surface* MakeGlyphSurface(video_t* video, int size, glyph_t* glyphs)
 {
-    ClearTextureCache(video);
-
-    TTF_CloseFont(video->font);
+    (void)video;
 
-    TTF_Quit();
+    const bakedfont_t* baked = ChooseBakedFont(size);
 
-    SDL_DestroyRenderer(video->renderer);
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, baked->width, baked->height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!atlas)
+    {
+        printf("Failed to create glyph surface: %s\n", SDL_GetError());
+        return NULL;
+    }
 
-    SDL_DestroyWindow(video->window);
+    for (int y = 0; y < baked->height; y++)
+    {
+        uint32_t* row = (uint32_t*)((uint8_t*)atlas->pixels + y * atlas->pitch);
+        for (int x = 0; x < baked->width; x++)
+        {
+            const int bit = y * baked->width + x;
+            const bool set = baked->bits[bit / 8] & (0x80 >> (bit % 8));
+            row[x] = set ? 0xffffffff : 0x00ffffff;
+        }
+    }
 
-    SDL_QuitSubSystem(SDL_INIT_VIDEO);
+    for (int i = 0; i < NUM_GLYPHS; i++)
+    {
+        const bakedglyph_t* glyph = &baked->glyphs[i];
+        glyphs[i].source = (SDL_Rect){ glyph->x, glyph->y, glyph->w, glyph->h };
+        glyphs[i].advance = glyph->advance;
+    }
 
-    S_Free(video->alloc, video);
+    return atlas;
 }
-
-void V_WindowResized(video_t* video, int w, int h)
+#else
+// every printable glyph drawn once in a grid, so text doesn't need to
+// touch the font again until its size changes
+static SDL_Surface* MakeGlyphSurface(video_t* video, int size, glyph_t* glyphs)
 {
-    video->width = w;
-    video->height = h;
+    TTF_Font* font = video->fontData ? FontAtSize(video, size) : NULL;
+    if (!font)
+    {
+        return NULL;
+    }
 
-    float m;
-    if (w > h)
-        m = h;
-    else
-        m = w;
+    const SDL_Color white = { 255, 255, 255, 255 };
 
-    // just a random quadratic formula formed from
-    // (0, 4)
-    // (1024, 28)
-    // (2000, 48)
-    // x being max size and y being font pt size
-    const int pt = 0.0000015 * m * m + 0.025 * m + 4;
-    TTF_SetFontSize(video->font, pt);
-    ClearTextureCache(video);
+    SDL_Surface* glyphSurfaces[NUM_GLYPHS];
+    int cellWidth = 1;
+    int cellHeight = 1;
+
+    for (int i = 0; i < NUM_GLYPHS; i++)
+    {
+        const uint16_t c = (uint16_t)(FIRST_GLYPH + i);
+
+        int advance = 0;
+        TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &advance);
+        glyphs[i].advance = advance;
+
+        // spaces & missing glyphs don't draw anything
+        glyphSurfaces[i] = c == ' ' ? NULL : TTF_RenderGlyph_Solid(font, c, white);
+        if (glyphSurfaces[i])
+        {
+            cellWidth = SDL_max(cellWidth, glyphSurfaces[i]->w);
+            cellHeight = SDL_max(cellHeight, glyphSurfaces[i]->h);
+        }
+    }
+
+    const int rows = (NUM_GLYPHS + GLYPH_ATLAS_COLUMNS - 1) / GLYPH_ATLAS_COLUMNS;
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, cellWidth * GLYPH_ATLAS_COLUMNS, cellHeight * rows, 32, SDL_PIXELFORMAT_ARGB8888);
+
+    for (int i = 0; i < NUM_GLYPHS; i++)
+    {
+        glyph_t* glyph = &glyphs[i];
+        glyph->source = (SDL_Rect){ 0, 0, 0, 0 };
+
+        if (!glyphSurfaces[i])
+        {
+            continue;
+        }
+
+        if (atlas)
+        {
+            glyph->source = (SDL_Rect){
+                .x = (i % GLYPH_ATLAS_COLUMNS) * cellWidth,
+                .y = (i / GLYPH_ATLAS_COLUMNS) * cellHeight,
+                .w = glyphSurfaces[i]->w,
+                .h = glyphSurfaces[i]->h
+            };
+
+            SDL_Rect dst = glyph->source;
+            SDL_BlitSurface(glyphSurfaces[i], NULL, atlas, &dst);
+        }
+
+        SDL_FreeSurface(glyphSurfaces[i]);
+    }
+
+    if (!atlas)
+    {
+        printf("Failed to create glyph surface: %s\n", SDL_GetError());
+    }
+
+    return atlas;
+}
+#endif
+
+// textures can only be made on the main thread, frees the surface either
+// way, the old atlas stays if the new one can't be made
+static bool UploadGlyphAtlas(video_t* video, SDL_Surface* atlas, const glyph_t* glyphs)
+{
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(video->renderer, atlas);
+    SDL_FreeSurface(atlas);
+
+    if (!texture)
+    {
+        printf("Failed to create glyph atlas: %s\n", SDL_GetError());
+        return false;
+    }
+
+    if (video->glyphAtlas)
+        SDL_DestroyTexture(video->glyphAtlas);
+
+    video->glyphAtlas = texture;
+    memcpy(video->glyphs, glyphs, sizeof video->glyphs);
+
+    return true;
+}
+
+static bool BuildGlyphAtlas(video_t* video)
+{
+    glyph_t glyphs[NUM_GLYPHS];
+    SDL_Surface* atlas = MakeGlyphSurface(video, video->fontSize, glyphs);
+
+    return atlas && UploadGlyphAtlas(video, atlas, glyphs);
+}
+
+// the loading thread, the main thread leaves the font alone & doesn't
+// look at the loaded fields until loaded gets set
+static int LoadText(void* data)
+{
+    video_t* video = data;
+
+#if !defined(BLOCKGAM_BAKED_FONT)
+    // no font just means no text, the game still works
+    if (!OpenFont(video))
+    {
+        SDL_AtomicSet(&video->loaded, 1);
+        return 0;
+    }
+#endif
+
+    video->loadedAtlas = MakeGlyphSurface(video, video->fontSize, video->loadedGlyphs);
+
+    SDL_AtomicSet(&video->loaded, 1);
+    return 0;
+}
+
+static double MillisecondsSince(uint64_t counter)
+{
+    return (SDL_GetPerformanceCounter() - counter) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+// scale the scene as big as it goes in the window without stretching it
+static void FitScene(video_t* video)
+{
+    int w = video->windowWidth;
+    int h = (int)((int64_t)w * video->height / video->width);
+    if (h > video->windowHeight)
+    {
+        h = video->windowHeight;
+        w = (int)((int64_t)h * video->width / video->height);
+    }
+
+    video->sceneRect = (SDL_Rect){
+        .x = (video->windowWidth - w) / 2,
+        .y = (video->windowHeight - h) / 2,
+        .w = w,
+        .h = h
+    };
+}
+
+static bool CreateScene(video_t* video, int w, int h, SDL_ScaleMode filter)
+{
+    video->scene = SDL_CreateTexture(video->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!video->scene)
+    {
+        printf("Failed to create scene texture: %s\n", SDL_GetError());
+        return false;
+    }
+
+    SDL_SetTextureScaleMode(video->scene, filter);
+    SDL_SetRenderTarget(video->renderer, video->scene);
+
+    video->width = w;
+    video->height = h;
+    FitScene(video);
+
+    return true;
+}
+
+video_t* V_Init(alloc_t* alloc, int width, int height)
+{
+    video_t* video = S_Allocate(alloc, sizeof(video_t));
+
+    video->alloc = alloc;
+    video->startCounter = SDL_GetPerformanceCounter();
+
+    // who needs error checking
+    SDL_InitSubSystem(SDL_INIT_VIDEO);
+
+    video->window = SDL_CreateWindow("blockgam", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+
+    video->renderer = SDL_CreateRenderer(video->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+    // something on screen before anything else gets made
+    SDL_SetRenderDrawColor(video->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(video->renderer);
+    SDL_RenderPresent(video->renderer);
+    printf("First frame after %.1f ms\n", MillisecondsSince(video->startCounter));
+
+    // vsync isn't always there, or honoured when it says it is, so the
+    // pacer keeps an eye on it
+    int refreshRate = 0;
+    SDL_DisplayMode mode;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(video->window), &mode) == 0)
+    {
+        refreshRate = mode.refresh_rate;
+    }
+
+    bool vsync = false;
+    video->softwareRenderer = false;
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(video->renderer, &info) == 0)
+    {
+        vsync = info.flags & SDL_RENDERER_PRESENTVSYNC;
+        video->softwareRenderer = info.flags & SDL_RENDERER_SOFTWARE;
+    }
+
+    // BLOCKGAM_FRAME_LIMIT=N always limits to N frames a second
+    const char* frameLimitEnv = SDL_getenv("BLOCKGAM_FRAME_LIMIT");
+    const int frameLimit = frameLimitEnv ? SDL_atoi(frameLimitEnv) : 0;
+
+    if (!(video->pacer = V_CreatePacer(alloc, refreshRate, frameLimit, vsync)))
+    {
+        fputs("Failed to create frame pacer\n", stderr);
+        return NULL;
+    }
+
+    if (!(video->particles = V_CreateParticles(alloc, MAX_PARTICLES)))
+    {
+        fputs("Failed to create particles\n", stderr);
+        return NULL;
+    }
+    video->lastParticleUpdate = SDL_GetPerformanceCounter();
+
+    video->fontSize = DEFAULT_FONT_SIZE;
+
+#if defined(BLOCKGAM_USE_TTF)
+    video->fontData = NULL;
+    video->fontTried = false;
+#endif
+
+    video->windowWidth = width;
+    video->windowHeight = height;
+
+    video->width = width;
+    video->height = height;
+
+    // BLOCKGAM_RENDER_SIZE=WxH draws everything at that size and scales it
+    // to the window, so a big window doesn't cost any more to fill
+    video->scene = NULL;
+    const char* renderSize = SDL_getenv("BLOCKGAM_RENDER_SIZE");
+    if (renderSize)
+    {
+        int renderWidth, renderHeight;
+        if (sscanf(renderSize, "%dx%d", &renderWidth, &renderHeight) == 2 && renderWidth > 0 && renderHeight > 0)
+        {
+            const char* filter = SDL_getenv("BLOCKGAM_RENDER_FILTER");
+            const bool linear = filter && strcmp(filter, "linear") == 0;
+
+            if (CreateScene(video, renderWidth, renderHeight, linear ? SDL_ScaleModeLinear : SDL_ScaleModeNearest))
+            {
+                SetFontSize(video);
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Bad render size %s, should look like 640x480\n", renderSize);
+        }
+    }
+
+    video->camera.zoom = 1;
+    video->camera.x = GRID_WIDTH / 2.0f;
+    video->camera.y = GRID_HEIGHT / 2.0f;
+    video->camera.follow = true;
+
+    video->boardCount = 1;
+
+    video->resizePending = false;
+
+    CalculateLayout(video);
+
+    // BLOCKGAM_CAPTURE=path records every frame, at the render size if
+    // there is one, so it can't change partway through
+    video->capture = NULL;
+    const char* capturePath = SDL_getenv("BLOCKGAM_CAPTURE");
+    if (capturePath)
+    {
+        const int frameRate = frameLimit > 0 ? frameLimit : (refreshRate > 0 ? refreshRate : 60);
+        if (!(video->capture = V_CreateCapture(alloc, capturePath, video->width, video->height, frameRate)))
+        {
+            fputs("Failed to start capture, carrying on without it\n", stderr);
+        }
+    }
+
+    video->visible = true;
+
+    int cacheEntries = TEXT_CACHE_ENTRIES;
+    int cacheKilobytes = TEXT_CACHE_KILOBYTES;
+    const char* textCache = SDL_getenv("BLOCKGAM_TEXT_CACHE");
+    if (textCache && (sscanf(textCache, "%d,%d", &cacheEntries, &cacheKilobytes) != 2 || cacheEntries < 1 || cacheKilobytes < 0))
+    {
+        fprintf(stderr, "Bad text cache size %s, should look like 64,4096\n", textCache);
+        cacheEntries = TEXT_CACHE_ENTRIES;
+        cacheKilobytes = TEXT_CACHE_KILOBYTES;
+    }
+
+    if (!(video->textCache = V_CreateTextCache(video->alloc, cacheEntries, (size_t)cacheKilobytes * 1024)))
+    {
+        fputs("Failed to create text cache\n", stderr);
+        return NULL;
+    }
+
+    video->textQuads = 0;
+    video->textVertices = S_Allocate(video->alloc, sizeof(SDL_Vertex) * 4 * MAX_TEXT_QUADS);
+    video->textIndices = S_Allocate(video->alloc, sizeof(int) * 6 * MAX_TEXT_QUADS);
+    if (!video->textVertices || !video->textIndices)
+    {
+        fputs("Failed to allocate memory for text batch\n", stderr);
+        return NULL;
+    }
+
+    for (int i = 0; i < MAX_TEXT_QUADS; i++)
+    {
+        int* index = video->textIndices + i * 6;
+        const int first = i * 4;
+
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first;
+        index[4] = first + 2;
+        index[5] = first + 3;
+    }
+
+    video->glyphAtlas = NULL;
+
+    video->batchQuads = 0;
+    video->batchMaxQuads = BATCH_START_QUADS;
+    video->batchVertices = S_Allocate(video->alloc, sizeof(SDL_Vertex) * 4 * video->batchMaxQuads);
+    video->batchIndices = S_Allocate(video->alloc, sizeof(int) * 6 * video->batchMaxQuads);
+    if (!video->batchVertices || !video->batchIndices)
+    {
+        fputs("Failed to allocate memory for draw batch\n", stderr);
+        return NULL;
+    }
+
+    video->boardCache = NULL;
+    video->boardCacheValid = false;
+    video->cachedBoardId = 0;
+    video->pendingRows = 0;
+
+    video->minimap = NULL;
+    video->minimapValid = false;
+    video->boardClipped = false;
+
+    // BLOCKGAM_RENDERER=framebuffer draws the board on the cpu instead,
+    // which does better when the renderer ends up being software anyway
+    video->boardRenderer = BOARDRENDERER_GEOMETRY;
+    const char* boardRenderer = SDL_getenv("BLOCKGAM_RENDERER");
+    if (boardRenderer && strcmp(boardRenderer, "framebuffer") == 0)
+    {
+        video->boardRenderer = BOARDRENDERER_FRAMEBUFFER;
+    }
+    else if (boardRenderer && strcmp(boardRenderer, "geometry") != 0)
+    {
+        fprintf(stderr, "Unknown renderer %s, using geometry\n", boardRenderer);
+    }
+
+    video->tilePixels = NULL;
+    video->boardPixels = NULL;
+    video->boardStream = NULL;
+    video->streamPixels = NULL;
+
+    video->tileAtlas = NULL;
+    if (!BuildTileAtlas(video))
+    {
+        fputs("Failed to create block tiles\n", stderr);
+        return NULL;
+    }
+
+    // last, nothing after this can fail & leave the thread running
+    video->loading = true;
+    video->loadedAtlas = NULL;
+    video->loadedSizeStale = false;
+    SDL_AtomicSet(&video->loaded, 0);
+    if (!(video->loader = SDL_CreateThread(LoadText, "load", video)))
+    {
+        fputs("Failed to start loading thread, loading here instead\n", stderr);
+        LoadText(video);
+    }
+
+    return video;
+}
+
+bool V_FinishLoading(video_t* video)
+{
+    if (!video->loading)
+    {
+        return true;
+    }
+
+    if (video->loader)
+    {
+        if (!SDL_AtomicGet(&video->loaded))
+        {
+            return false;
+        }
+
+        SDL_WaitThread(video->loader, NULL);
+        video->loader = NULL;
+    }
+
+    video->loading = false;
+
+    if (video->loadedSizeStale)
+    {
+        // start again at the right size, it's quick now the font's open
+        if (video->loadedAtlas)
+            SDL_FreeSurface(video->loadedAtlas);
+        video->loadedAtlas = NULL;
+
+        SetFontSize(video);
+        video->loadedAtlas = MakeGlyphSurface(video, video->fontSize, video->loadedGlyphs);
+    }
+
+    if (!video->loadedAtlas || !UploadGlyphAtlas(video, video->loadedAtlas, video->loadedGlyphs))
+    {
+        // not the end of the world, text still gets drawn a string at a
+        // time if there's a font to do it
+        fputs("Failed to build glyph atlas\n", stderr);
+    }
+    video->loadedAtlas = NULL;
+
+    printf("Loaded after %.1f ms\n", MillisecondsSince(video->startCounter));
+
+    return true;
+}
+
+void V_DrawLoading(video_t* video)
+{
+    // no text yet, just a few blocks
+    const int size = SDL_max(SDL_min(video->width, video->height) / 32, 4);
+    const int lit = (int)(SDL_GetTicks64() / LOADING_STEP_MS % LOADING_BLOCKS);
+
+    SDL_Rect rect = {
+        .x = (video->width - size * (LOADING_BLOCKS * 2 - 1)) / 2,
+        .y = (video->height - size) / 2,
+        .w = size,
+        .h = size
+    };
+
+    for (int i = 0; i < LOADING_BLOCKS; i++)
+    {
+        const SDL_Color color = i == lit ? tileColors[i + 1] : (SDL_Color){ 60, 60, 60, 255 };
+        SDL_SetRenderDrawColor(video->renderer, color.r, color.g, color.b, 255);
+        SDL_RenderFillRect(video->renderer, &rect);
+
+        rect.x += size * 2;
+    }
+}
+
+// copy a tile out of the atlas
+static void FlushBatch(video_t* video);
+
+static void AddBatchTile(video_t* video, int x, int y, int w, int h, int tile)
+{
+    if (video->batchQuads == video->batchMaxQuads)
+    {
+        const int maxQuads = video->batchMaxQuads * 2;
+
+        // a bigger buffer that did get made is still fine to keep using
+        SDL_Vertex* vertices = S_Reallocate(video->alloc, video->batchVertices, sizeof(SDL_Vertex) * 4 * maxQuads);
+        if (vertices)
+            video->batchVertices = vertices;
+
+        int* indices = vertices ? S_Reallocate(video->alloc, video->batchIndices, sizeof(int) * 6 * maxQuads) : NULL;
+        if (indices)
+            video->batchIndices = indices;
+
+        if (vertices && indices)
+        {
+            video->batchMaxQuads = maxQuads;
+        }
+        else
+        {
+            // draw what's there & start over in the buffers we have
+            fputs("Failed to grow tile batch\n", stderr);
+            FlushBatch(video);
+        }
+    }
+
+    SDL_Vertex* v = video->batchVertices + video->batchQuads * 4;
+    int* i = video->batchIndices + video->batchQuads * 6;
+    const int first = video->batchQuads * 4;
+
+    const SDL_Color white = { 255, 255, 255, 255 };
+    const float u0 = (float)tile / NUM_TILES;
+    const float u1 = (float)(tile + 1) / NUM_TILES;
+
+    v[0] = (SDL_Vertex){ .position = { (float)x, (float)y }, .color = white, .tex_coord = { u0, 0.0f } };
+    v[1] = (SDL_Vertex){ .position = { (float)(x + w), (float)y }, .color = white, .tex_coord = { u1, 0.0f } };
+    v[2] = (SDL_Vertex){ .position = { (float)(x + w), (float)(y + h) }, .color = white, .tex_coord = { u1, 1.0f } };
+    v[3] = (SDL_Vertex){ .position = { (float)x, (float)(y + h) }, .color = white, .tex_coord = { u0, 1.0f } };
+
+    i[0] = first;
+    i[1] = first + 1;
+    i[2] = first + 2;
+    i[3] = first;
+    i[4] = first + 2;
+    i[5] = first + 3;
+
+    video->batchQuads++;
+}
+
+// part of the board cache that's in view, in cache pixels, the cache
+// holds spaces (-1, -1) to (GRID_WIDTH, GRID_HEIGHT)
+static SDL_Rect VisibleCacheRect(const video_t* video)
+{
+    const int pixelSize = video->layout.cellSize;
+    const cellrange_t* visible = &video->layout.visible;
+
+    SDL_Rect rect = {
+        .x = (visible->firstX + 1) * pixelSize,
+        .y = (GRID_HEIGHT - visible->lastY) * pixelSize,
+        .w = (visible->lastX - visible->firstX + 1) * pixelSize,
+        .h = (visible->lastY - visible->firstY + 1) * pixelSize
+    };
+    return rect;
+}
+
+// draws part of a board cache sized texture where it goes on screen
+static void CopyBoardCache(video_t* video, SDL_Texture* texture, const SDL_Rect* area)
+{
+    const layout_t* layout = &video->layout;
+
+    SDL_Rect drect = {
+        .x = layout->boardX - layout->cellSize + area->x,
+        .y = layout->boardY - GRID_HEIGHT * layout->cellSize + area->y,
+        .w = area->w,
+        .h = area->h
+    };
+    SDL_RenderCopy(video->renderer, texture, area, &drect);
+}
+
+// upload the board drawn on the cpu this frame, if there is one
+static void FlushFramebuffer(video_t* video)
+{
+    if (!video->streamPixels)
+    {
+        return;
+    }
+
+    SDL_UnlockTexture(video->boardStream);
+    video->streamPixels = NULL;
+
+    CopyBoardCache(video, video->boardStream, &video->streamArea);
+}
+
+// draw everything batched so far, has to happen before anything else
+// gets drawn so things stay in order
+static void FlushBatch(video_t* video)
+{
+    FlushFramebuffer(video);
+
+    if (video->batchQuads > 0)
+    {
+        SDL_RenderGeometry(video->renderer, video->tileAtlas, video->batchVertices, video->batchQuads * 4, video->batchIndices, video->batchQuads * 6);
+        video->batchQuads = 0;
+    }
+
+    if (video->textQuads > 0)
+    {
+        SDL_RenderGeometry(video->renderer, video->glyphAtlas, video->textVertices, video->textQuads * 4, video->textIndices, video->textQuads * 6);
+        video->textQuads = 0;
+    }
+
+    // the board clip only lasts until the board & piece are drawn
+    if (video->boardClipped)
+    {
+        SDL_RenderSetClipRect(video->renderer, NULL);
+        video->boardClipped = false;
+    }
+}
+
+void V_Clear(video_t* video, int r, int g, int b)
+{
+    SDL_SetRenderDrawColor(video->renderer, r, g, b, 255);
+    SDL_RenderClear(video->renderer);
+}
+
+void V_SetVisibility(video_t* video, bool visible)
+{
+    video->visible = visible;
+}
+
+bool V_IsVisible(video_t* video)
+{
+    return video->visible;
+}
+
+#if defined(BLOCKGAM_USE_TTF)
+// the slow way, a texture for the whole string
+static void DrawTextTexture(video_t* video, int x, int y, const char* text)
+{
+    FlushBatch(video);
+
+    SDL_Rect rect = { .x = x, .y = y };
+
+    SDL_Texture* texture = V_FindText(video->textCache, text, video->fontSize, &rect.w, &rect.h);
+    if (!texture)
+    {
+        TTF_Font* font = FontAtSize(video, video->fontSize);
+        if (!font)
+        {
+            return;
+        }
+
+        SDL_Color textColor = { 255, 255, 255, 255 };
+        SDL_Surface* surface = TTF_RenderUTF8_Solid(font, text, textColor);
+        if (!surface)
+        {
+            printf("Couldn't render text \"%s\": %s\n", text, SDL_GetError());
+            return;
+        }
+
+        texture = SDL_CreateTextureFromSurface(video->renderer, surface);
+        rect.w = surface->w;
+        rect.h = surface->h;
+        SDL_FreeSurface(surface);
+
+        if (!texture)
+        {
+            printf("Failed to convert SDL_Surface to SDL_Texture: %s\n", SDL_GetError());
+            return;
+        }
+
+        V_AddText(video->textCache, text, video->fontSize, texture, rect.w, rect.h);
+    }
+
+    SDL_RenderCopy(video->renderer, texture, NULL, &rect);
+}
+#endif
+
+static bool IsPlainText(const char* text)
+{
+    for (const char* c = text; *c; c++)
+    {
+        if (*c < FIRST_GLYPH || *c > LAST_GLYPH)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void DrawText(video_t* video, int x, int y, const char* text)
+{
+    // the loader might still have the font
+    if (video->loading)
+    {
+        return;
+    }
+
+    if (!video->glyphAtlas || !IsPlainText(text))
+    {
+#if defined(BLOCKGAM_USE_TTF)
+        if (OpenFont(video))
+        {
+            DrawTextTexture(video, x, y, text);
+            return;
+        }
+#endif
+
+        // no font to fall back on, anything the atlas doesn't have comes
+        // out as a ?
+        if (!video->glyphAtlas)
+        {
+            return;
+        }
+    }
+
+    const SDL_Color white = { 255, 255, 255, 255 };
+
+    int atlasWidth, atlasHeight;
+    SDL_QueryTexture(video->glyphAtlas, NULL, NULL, &atlasWidth, &atlasHeight);
+
+    for (const char* c = text; *c; c++)
+    {
+        const unsigned char ch = (unsigned char)*c;
+
+        // just one ? for each utf-8 character
+        if ((ch & 0xc0) == 0x80)
+        {
+            continue;
+        }
+
+        const int index = ch >= FIRST_GLYPH && ch <= LAST_GLYPH ? ch - FIRST_GLYPH : '?' - FIRST_GLYPH;
+        const glyph_t* glyph = &video->glyphs[index];
+        const SDL_Rect* src = &glyph->source;
+
+        if (src->w > 0)
+        {
+            if (video->textQuads == MAX_TEXT_QUADS)
+            {
+                FlushBatch(video);
+            }
+
+            SDL_Vertex* v = video->textVertices + video->textQuads * 4;
+
+            const float left = (float)x;
+            const float top = (float)y;
+            const float right = (float)(x + src->w);
+            const float bottom = (float)(y + src->h);
+
+            const float u0 = (float)src->x / atlasWidth;
+            const float v0 = (float)src->y / atlasHeight;
+            const float u1 = (float)(src->x + src->w) / atlasWidth;
+            const float v1 = (float)(src->y + src->h) / atlasHeight;
+
+            v[0] = (SDL_Vertex){ .position = { left, top }, .color = white, .tex_coord = { u0, v0 } };
+            v[1] = (SDL_Vertex){ .position = { right, top }, .color = white, .tex_coord = { u1, v0 } };
+            v[2] = (SDL_Vertex){ .position = { right, bottom }, .color = white, .tex_coord = { u1, v1 } };
+            v[3] = (SDL_Vertex){ .position = { left, bottom }, .color = white, .tex_coord = { u0, v1 } };
+
+            video->textQuads++;
+        }
+
+        x += glyph->advance;
+    }
+}
+
+void V_DrawMenu(video_t* video, menu_t* menu)
+{
+    menulist_t* list = M_GetList(menu);
+    if (!list)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < list->numItems; i++)
+    {
+        SDL_SetRenderDrawColor(video->renderer, 255, 0, 0, 1);
+        DrawText(video, video->layout.menuX, (int)i * video->layout.menuRowHeight + video->layout.menuY, list->items[i]->label);
+    }
+
+    FlushBatch(video);
+
+    const size_t currItem = M_GetCurrentItem(menu);
+    SDL_Rect selectRect = {
+        .x = video->layout.menuMarkerX,
+        .y = (int)currItem * video->layout.menuRowHeight + video->layout.menuMarkerY,
+        .w = video->layout.menuMarkerSize,
+        .h = video->layout.menuMarkerSize
+    };
+    SDL_RenderFillRect(video->renderer, &selectRect);
+}
+
+// (originX, originY) is the top left corner of space (0, 0)
+inline static void DrawBoardSpaceAt(video_t* video, int originX, int originY, int x, int y, uint8_t c)
+{
+    // empty spaces are covered by the play space background
+    if (c == 0)
+    {
+        return;
+    }
+
+    const int pixelSize = video->layout.cellSize;
+
+    AddBatchTile(video, originX + x * pixelSize, originY - y * pixelSize, pixelSize, pixelSize, TileIndex(c));
+}
+
+// only the spaces in range get drawn
+static void DrawBoardRows(video_t* video, board_t* board, int originX, int originY, const cellrange_t* range, uint64_t rows)
+{
+    const int pixelSize = video->layout.cellSize;
+
+    const int firstX = ClampInt(range->firstX, 0, GRID_WIDTH - 1);
+    const int lastX = ClampInt(range->lastX, 0, GRID_WIDTH - 1);
+    const int firstY = ClampInt(range->firstY, 0, GRID_HEIGHT - 1);
+    const int lastY = ClampInt(range->lastY, 0, GRID_HEIGHT - 1);
+
+    for (int y = firstY; y <= lastY; y++)
+    {
+        if (!(rows & (UINT64_C(1) << y)))
+        {
+            continue;
+        }
+
+        // draw play space background
+        AddBatchTile(video, originX + firstX * pixelSize, originY - y * pixelSize, (lastX - firstX + 1) * pixelSize, pixelSize, TILE_EMPTY);
+
+        // draw play space
+        for (int x = firstX; x <= lastX; x++)
+        {
+            DrawBoardSpaceAt(video, originX, originY, x, y, G_GetBoardSpace(board, x, y));
+        }
+    }
+}
+
+static void DrawBorder(video_t* video, int originX, int originY, const cellrange_t* range)
+{
+    // draw bottom of playspace
+    if (range->firstY == -1)
+    {
+        for (int x = range->firstX; x <= range->lastX; x++)
+        {
+            DrawBoardSpaceAt(video, originX, originY, x, -1, GREY_COLOR);
+        }
+    }
+
+    const int firstY = ClampInt(range->firstY, 0, GRID_HEIGHT);
+
+    // draw left side of playspace
+    if (range->firstX == -1)
+    {
+        for (int y = firstY; y <= range->lastY; y++)
+        {
+            DrawBoardSpaceAt(video, originX, originY, -1, y, GREY_COLOR);
+        }
+    }
+
+    // draw right side of playspace
+    if (range->lastX == GRID_WIDTH)
+    {
+        for (int y = firstY; y <= range->lastY; y++)
+        {
+            DrawBoardSpaceAt(video, originX, originY, GRID_WIDTH, y, GREY_COLOR);
+        }
+    }
+}
+
+// works out which rows need drawing into a board cache, rows out of view
+// wait in pendingRows until the camera gets to them
+static uint64_t TakeDirtyRows(video_t* video, board_t* board, bool redrawAll)
+{
+    if (redrawAll)
+        video->pendingRows = ALL_ROWS;
+    else
+        video->pendingRows |= G_GetBoardDirtyRows(board, video->cachedGeneration);
+
+    const uint64_t rows = video->pendingRows & video->layout.visibleRows;
+    video->pendingRows &= ~rows;
+
+    video->boardCacheValid = true;
+    video->cachedBoardId = G_GetBoardId(board);
+    video->cachedGeneration = G_GetBoardGeneration(board);
+
+    return rows;
+}
+
+// the cache holds spaces (-1, -1) to (GRID_WIDTH, GRID_HEIGHT)
+// returns false if the renderer can't draw to textures
+static bool UpdateBoardCache(video_t* video, board_t* board)
+{
+    const int pixelSize = video->layout.cellSize;
+
+    if (!video->boardCache)
+    {
+        video->boardCache = SDL_CreateTexture(video->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, (GRID_WIDTH + 2) * pixelSize, (GRID_HEIGHT + 2) * pixelSize);
+        if (!video->boardCache)
+        {
+            return false;
+        }
+
+        // the corners above the play space are see through
+        SDL_SetTextureBlendMode(video->boardCache, SDL_BLENDMODE_BLEND);
+        video->boardCacheValid = false;
+    }
+
+    const bool redrawAll = !video->boardCacheValid || video->cachedBoardId != G_GetBoardId(board);
+    const uint64_t rows = TakeDirtyRows(video, board, redrawAll);
+
+    if (rows == 0 && !redrawAll)
+    {
+        return true;
+    }
+
+    FlushBatch(video);
+    SDL_SetRenderTarget(video->renderer, video->boardCache);
+
+    if (redrawAll)
+    {
+        SDL_SetRenderDrawColor(video->renderer, 0, 0, 0, 0);
+        SDL_RenderClear(video->renderer);
+        DrawBorder(video, pixelSize, GRID_HEIGHT * pixelSize, &allCells);
+    }
+
+    DrawBoardRows(video, board, pixelSize, GRID_HEIGHT * pixelSize, &allCells, rows);
+
+    FlushBatch(video);
+    SDL_SetRenderTarget(video->renderer, video->scene);
+
+    return true;
+}
+
+static void DestroyBoardCache(video_t* video)
+{
+    if (video->boardCache)
+    {
+        SDL_DestroyTexture(video->boardCache);
+        video->boardCache = NULL;
+    }
+
+    video->boardCacheValid = false;
+}
+
+inline static void FillSpan(uint32_t* dst, uint32_t color, int count)
+{
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128i wide = _mm_set1_epi32((int)color);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)(dst + i), wide);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = color;
+    }
+}
+
+inline static void CopySpan(uint32_t* dst, const uint32_t* src, int count)
+{
+    int i = 0;
+#ifdef USE_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = src[i];
+    }
+}
+
+// pixels holds area of the board cache, pitch is in pixels, (left, top)
+// is in board cache pixels too
+// blocks hanging off the edge of the area get cut off
+static void RasterTile(video_t* video, uint32_t* pixels, int pitch, const SDL_Rect* area, int left, int top, int tile)
+{
+    const int pixelSize = video->layout.cellSize;
+    const int atlasPitch = NUM_TILES * pixelSize;
+
+    left -= area->x;
+    top -= area->y;
+
+    const int clipLeft = left < 0 ? -left : 0;
+    const int clipTop = top < 0 ? -top : 0;
+    const int width = ClampInt(area->w - left, 0, pixelSize) - clipLeft;
+    const int height = ClampInt(area->h - top, 0, pixelSize) - clipTop;
+
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    const uint32_t* src = video->tilePixels + clipTop * atlasPitch + tile * pixelSize + clipLeft;
+    uint32_t* dst = pixels + (top + clipTop) * pitch + left + clipLeft;
+
+    for (int row = 0; row < height; row++)
+    {
+        CopySpan(dst, src, width);
+        src += atlasPitch;
+        dst += pitch;
+    }
+}
+
+inline static void RasterBoardSpace(video_t* video, uint32_t* pixels, int pitch, const SDL_Rect* area, int x, int y, uint8_t c)
+{
+    if (c == 0)
+    {
+        return;
+    }
+
+    const int pixelSize = video->layout.cellSize;
+    RasterTile(video, pixels, pitch, area, (x + 1) * pixelSize, (GRID_HEIGHT - y) * pixelSize, TileIndex(c));
+}
+
+static void RasterBoardRows(video_t* video, board_t* board, const SDL_Rect* area, uint64_t rows)
+{
+    const int pixelSize = video->layout.cellSize;
+    const int pitch = area->w;
+
+    // the empty tile is plain black all over
+    const uint32_t background = video->tilePixels[0];
+
+    for (int y = 0; y < GRID_HEIGHT; y++)
+    {
+        if (!(rows & (UINT64_C(1) << y)))
+        {
+            continue;
+        }
+
+        uint32_t* row = video->boardPixels + (GRID_HEIGHT - y) * pixelSize * pitch + pixelSize;
+        for (int line = 0; line < pixelSize; line++)
+        {
+            FillSpan(row + line * pitch, background, GRID_WIDTH * pixelSize);
+        }
+
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            RasterBoardSpace(video, video->boardPixels, pitch, area, x, y, G_GetBoardSpace(board, x, y));
+        }
+    }
+}
+
+static void RasterBorder(video_t* video, const SDL_Rect* area)
+{
+    for (int x = -1; x <= GRID_WIDTH; x++)
+    {
+        RasterBoardSpace(video, video->boardPixels, area->w, area, x, -1, GREY_COLOR);
+    }
+
+    for (int y = 0; y <= GRID_HEIGHT; y++)
+    {
+        RasterBoardSpace(video, video->boardPixels, area->w, area, -1, y, GREY_COLOR);
+        RasterBoardSpace(video, video->boardPixels, area->w, area, GRID_WIDTH, y, GREY_COLOR);
+    }
+}
+
+// cpu side version of UpdateBoardCache
+static bool UpdateBoardPixels(video_t* video, board_t* board)
+{
+    const int pixelSize = video->layout.cellSize;
+    const SDL_Rect area = { 0, 0, (GRID_WIDTH + 2) * pixelSize, (GRID_HEIGHT + 2) * pixelSize };
+
+    if (!video->tilePixels)
+    {
+        return false;
+    }
+
+    if (!video->boardPixels)
+    {
+        video->boardPixels = S_Allocate(video->alloc, sizeof(uint32_t) * area.w * area.h);
+        if (!video->boardPixels)
+        {
+            return false;
+        }
+
+        video->boardCacheValid = false;
+    }
+
+    const bool redrawAll = !video->boardCacheValid || video->cachedBoardId != G_GetBoardId(board);
+    const uint64_t rows = TakeDirtyRows(video, board, redrawAll);
+
+    if (redrawAll)
+    {
+        // the corners above the play space are see through
+        FillSpan(video->boardPixels, 0, area.w * area.h);
+        RasterBorder(video, &area);
+    }
+
+    RasterBoardRows(video, board, &area, rows);
+
+    return true;
+}
+
+// copies the part of the board in view into the stream texture and leaves
+// it locked, so the piece can be drawn over it before FlushFramebuffer
+// uploads it
+static bool DrawBoardFramebuffer(video_t* video, board_t* board)
+{
+    const int pixelSize = video->layout.cellSize;
+    const int width = (GRID_WIDTH + 2) * pixelSize;
+    const int height = (GRID_HEIGHT + 2) * pixelSize;
+
+    if (!video->boardStream)
+    {
+        video->boardStream = SDL_CreateTexture(video->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (!video->boardStream)
+        {
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(video->boardStream, SDL_BLENDMODE_BLEND);
+    }
+
+    if (!UpdateBoardPixels(video, board))
+    {
+        return false;
+    }
+
+    // anything already batched goes under the board
+    FlushBatch(video);
+
+    const SDL_Rect area = VisibleCacheRect(video);
+
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(video->boardStream, &area, &pixels, &pitch) != 0)
+    {
+        return false;
+    }
+
+    video->streamPixels = pixels;
+    video->streamPitch = pitch / sizeof(uint32_t);
+    video->streamArea = area;
+
+    for (int y = 0; y < area.h; y++)
+    {
+        CopySpan(video->streamPixels + y * video->streamPitch, video->boardPixels + (area.y + y) * width + area.x, area.w);
+    }
+
+    return true;
+}
+
+static void DestroyBoardFramebuffer(video_t* video)
+{
+    if (video->boardStream)
+    {
+        if (video->streamPixels)
+            SDL_UnlockTexture(video->boardStream);
+
+        SDL_DestroyTexture(video->boardStream);
+        video->boardStream = NULL;
+    }
+    video->streamPixels = NULL;
+
+    if (video->boardPixels)
+    {
+        S_Free(video->alloc, video->boardPixels);
+        video->boardPixels = NULL;
+    }
+
+    video->boardCacheValid = false;
+}
+
+inline static uint32_t MinimapColor(uint8_t c)
+{
+    const SDL_Color color = tileColors[TileIndex(c)];
+    return 0xff000000 | (uint32_t)color.r << 16 | (uint32_t)color.g << 8 | color.b;
+}
+
+static void DrawMinimap(video_t* video, board_t* board)
+{
+    const layout_t* layout = &video->layout;
+
+    if (!video->minimap)
+    {
+        video->minimap = SDL_CreateTexture(video->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, GRID_WIDTH, GRID_HEIGHT);
+        if (!video->minimap)
+        {
+            return;
+        }
+
+        SDL_SetTextureScaleMode(video->minimap, SDL_ScaleModeNearest);
+        video->minimapValid = false;
+    }
+
+    const bool redrawAll = !video->minimapValid || video->minimapBoardId != G_GetBoardId(board);
+    const uint64_t rows = redrawAll ? ALL_ROWS : G_GetBoardDirtyRows(board, video->minimapGeneration);
+
+    if (rows != 0)
+    {
+        for (int y = 0; y < GRID_HEIGHT; y++)
+        {
+            if (!(rows & (UINT64_C(1) << y)))
+            {
+                continue;
+            }
+
+            uint32_t* row = video->minimapPixels + (GRID_HEIGHT - 1 - y) * GRID_WIDTH;
+            for (int x = 0; x < GRID_WIDTH; x++)
+            {
+                row[x] = MinimapColor(G_GetBoardSpace(board, x, y));
+            }
+        }
+
+        SDL_UpdateTexture(video->minimap, NULL, video->minimapPixels, GRID_WIDTH * sizeof(uint32_t));
+
+        video->minimapValid = true;
+        video->minimapBoardId = G_GetBoardId(board);
+        video->minimapGeneration = G_GetBoardGeneration(board);
+    }
+
+    SDL_Rect drect = {
+        .x = layout->minimapX,
+        .y = layout->minimapY,
+        .w = GRID_WIDTH * layout->minimapCellSize,
+        .h = GRID_HEIGHT * layout->minimapCellSize
+    };
+    SDL_RenderCopy(video->renderer, video->minimap, NULL, &drect);
+
+    SDL_SetRenderDrawColor(video->renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(video->renderer, &layout->minimapView);
+}
+
+void V_DrawBoard(video_t* video, board_t* board)
+{
+    const layout_t* layout = &video->layout;
+
+    // anything already batched goes under the board
+    FlushBatch(video);
+
+    if (video->camera.zoom > 1)
+    {
+        DrawMinimap(video, board);
+    }
+
+    bool drawn;
+    if (video->boardRenderer == BOARDRENDERER_FRAMEBUFFER && DrawBoardFramebuffer(video, board))
+        drawn = true;
+    else
+        drawn = UpdateBoardCache(video, board);
+
+    // pieces & blocks partly in view stay inside the viewport, the clip has
+    // to go on after the caches are done switching render targets
+    if (video->camera.zoom > 1)
+    {
+        SDL_RenderSetClipRect(video->renderer, &layout->viewport);
+        video->boardClipped = true;
+    }
+
+    if (!drawn)
+    {
+        // no render targets, so draw what's in view every frame
+        DrawBoardRows(video, board, layout->boardX, layout->boardY, &layout->visible, ALL_ROWS);
+        DrawBorder(video, layout->boardX, layout->boardY, &layout->visible);
+        return;
+    }
+
+    if (!video->streamPixels)
+    {
+        const SDL_Rect area = VisibleCacheRect(video);
+        CopyBoardCache(video, video->boardCache, &area);
+    }
+}
+
+void V_DrawPiece(video_t* video, piece_t* piece, float fall)
+{
+    const layout_t* layout = &video->layout;
+    const int pixelSize = layout->cellSize;
+
+    const int x = G_GetPieceX(piece);
+    const int y = G_GetPieceY(piece);
+    const int lift = (int)(fall * pixelSize);
+
+    const int halfWidth = PIECE_WIDTH / 2;
+    const int halfHeight = PIECE_HEIGHT / 2;
+
+    for (int i = -halfWidth; i <= halfWidth; i++)
+    {
+        for (int j = -halfHeight; j <= halfHeight; j++)
+        {
+            uint8_t c = G_GetPieceSpace(piece, i, j);
+            if (!c)
+            {
+                continue;
+            }
+
+            if (video->streamPixels)
+                RasterTile(video, video->streamPixels, video->streamPitch, &video->streamArea, (x + i + 1) * pixelSize, (GRID_HEIGHT - y - j) * pixelSize - lift, TileIndex(c));
+            else
+                AddBatchTile(video, layout->boardX + (x + i) * pixelSize, layout->boardY - (y + j) * pixelSize - lift, pixelSize, pixelSize, TileIndex(c));
+        }
+    }
+}
+
+// top left corner of space (0, 0) of one of the boards on the wall
+static void SlotOrigin(const video_t* video, int slot, int* originX, int* originY)
+{
+    const layout_t* layout = &video->layout;
+    const int pixelSize = layout->wallCellSize;
+    const int column = slot % layout->wallColumns;
+    const int row = slot / layout->wallColumns;
+
+    *originX = layout->wallX + (column * (GRID_WIDTH + 2 + WALL_GAP) + 1) * pixelSize;
+    *originY = layout->wallY + (row * (GRID_HEIGHT + 2 + WALL_GAP) + GRID_HEIGHT) * pixelSize;
+}
+
+// particles all live in the first board's spaces, so they can be drawn
+// together, this is where another board is in those
+static void SlotOffset(const video_t* video, int slot, float* offsetX, float* offsetY)
+{
+    *offsetX = 0.0f;
+    *offsetY = 0.0f;
+
+    if (video->boardCount > 1)
+    {
+        const int columns = video->layout.wallColumns;
+        *offsetX = (float)((slot % columns) * (GRID_WIDTH + 2 + WALL_GAP));
+        *offsetY = -(float)((slot / columns) * (GRID_HEIGHT + 2 + WALL_GAP));
+    }
+}
+
+void V_DrawBoardSlot(video_t* video, int slot, board_t* board, piece_t* piece, float fall, bool failed)
+{
+    const int pixelSize = video->layout.wallCellSize;
+
+    int originX, originY;
+    SlotOrigin(video, slot, &originX, &originY);
+
+    // the empty tile is flat, so it stretches over the whole play space
+    AddBatchTile(video, originX, originY - (GRID_HEIGHT - 1) * pixelSize, GRID_WIDTH * pixelSize, GRID_HEIGHT * pixelSize, TILE_EMPTY);
+
+    for (int x = -1; x <= GRID_WIDTH; x++)
+    {
+        AddBatchTile(video, originX + x * pixelSize, originY + pixelSize, pixelSize, pixelSize, TILE_GREY);
+    }
+
+    for (int y = 0; y <= GRID_HEIGHT; y++)
+    {
+        AddBatchTile(video, originX - pixelSize, originY - y * pixelSize, pixelSize, pixelSize, TILE_GREY);
+        AddBatchTile(video, originX + GRID_WIDTH * pixelSize, originY - y * pixelSize, pixelSize, pixelSize, TILE_GREY);
+    }
+
+    for (int y = 0; y < GRID_HEIGHT; y++)
+    {
+        for (int x = 0; x < GRID_WIDTH; x++)
+        {
+            const uint8_t c = G_GetBoardSpace(board, x, y);
+            if (c)
+            {
+                AddBatchTile(video, originX + x * pixelSize, originY - y * pixelSize, pixelSize, pixelSize, failed ? TILE_GREY : TileIndex(c));
+            }
+        }
+    }
+
+    if (!piece)
+    {
+        return;
+    }
+
+    const int x = G_GetPieceX(piece);
+    const int y = G_GetPieceY(piece);
+    const int lift = (int)(fall * pixelSize);
+
+    for (int i = -PIECE_WIDTH / 2; i <= PIECE_WIDTH / 2; i++)
+    {
+        for (int j = -PIECE_HEIGHT / 2; j <= PIECE_HEIGHT / 2; j++)
+        {
+            const uint8_t c = G_GetPieceSpace(piece, i, j);
+            if (c)
+            {
+                AddBatchTile(video, originX + (x + i) * pixelSize, originY - (y + j) * pixelSize - lift, pixelSize, pixelSize, TileIndex(c));
+            }
+        }
+    }
+}
+
+void V_SetBoardCount(video_t* video, int count)
+{
+    video->boardCount = count;
+
+    // the camera only looks at one board
+    if (count > 1 && video->camera.zoom > 1)
+    {
+        V_ZoomCamera(video, 1 - video->camera.zoom);
+    }
+
+    CalculateLayout(video);
+}
+
+void V_BurstRow(video_t* video, int slot, int y, const uint8_t* cells)
+{
+    float offsetX, offsetY;
+    SlotOffset(video, slot, &offsetX, &offsetY);
+
+    for (int x = 0; x < GRID_WIDTH; x++)
+    {
+        if (!cells[x])
+        {
+            continue;
+        }
+
+        const SDL_Color color = tileColors[TileIndex(cells[x])];
+        const emitter_t burst = {
+            .x = offsetX + x + 0.5f,
+            .y = offsetY + y + 0.5f,
+            .spread = 0.4f,
+            .speed = 8.0f,
+            .lift = 6.0f,
+            .life = 0.8f,
+            .size = 0.2f,
+            .r = color.r,
+            .g = color.g,
+            .b = color.b
+        };
+        V_EmitParticles(video->particles, &burst, BURST_PARTICLES);
+    }
+}
+
+void V_LandingDust(video_t* video, int slot, int x, int y)
+{
+    float offsetX, offsetY;
+    SlotOffset(video, slot, &offsetX, &offsetY);
+
+    const SDL_Color color = tileColors[TILE_GREY];
+    const emitter_t dust = {
+        .x = offsetX + x + 0.5f,
+        .y = offsetY + y,
+        .spread = 0.4f,
+        .speed = 1.5f,
+        .lift = 1.5f,
+        .life = 0.3f,
+        .size = 0.1f,
+        .r = color.r,
+        .g = color.g,
+        .b = color.b
+    };
+    V_EmitParticles(video->particles, &dust, DUST_PARTICLES);
+}
+
+void V_DrawEffects(video_t* video)
+{
+    const uint64_t now = SDL_GetPerformanceCounter();
+    // don't jump ahead after sleeping on another screen
+    const float dt = SDL_min((now - video->lastParticleUpdate) * 1.0f / SDL_GetPerformanceFrequency(), 0.1f);
+    video->lastParticleUpdate = now;
+
+    V_UpdateParticles(video->particles, dt);
+    if (V_CountParticles(video->particles) == 0)
+    {
+        return;
+    }
+
+    // on top of the board & piece
+    FlushBatch(video);
+
+    const layout_t* layout = &video->layout;
+
+    // same as the board clip, they can fly off the board but not out of
+    // the viewport
+    if (video->camera.zoom > 1)
+        SDL_RenderSetClipRect(video->renderer, &layout->viewport);
+
+    if (video->boardCount > 1)
+    {
+        int originX, originY;
+        SlotOrigin(video, 0, &originX, &originY);
+        V_DrawParticles(video->particles, video->renderer, originX, originY + layout->wallCellSize, layout->wallCellSize);
+    }
+    else
+    {
+        V_DrawParticles(video->particles, video->renderer, layout->boardX, layout->boardY + layout->cellSize, layout->cellSize);
+    }
+
+    if (video->camera.zoom > 1)
+        SDL_RenderSetClipRect(video->renderer, NULL);
+}
+
+void V_AimCamera(video_t* video, piece_t* piece)
+{
+    if (!video->camera.follow || !piece)
+    {
+        return;
+    }
+
+    // middle of the piece's centre space
+    video->camera.x = G_GetPieceX(piece) + 0.5f;
+    video->camera.y = G_GetPieceY(piece) + 0.5f;
+    ApplyCamera(video);
+}
+
+void V_ZoomCamera(video_t* video, int steps)
+{
+    const int zoom = ClampInt(video->camera.zoom + steps, 1, video->boardCount > 1 ? 1 : MAX_ZOOM);
+    if (zoom == video->camera.zoom)
+    {
+        return;
+    }
+
+    video->camera.zoom = zoom;
+    ApplyCamera(video);
+
+    // blocks are a different size now
+    BuildTileAtlas(video);
+    DestroyBoardCache(video);
+    DestroyBoardFramebuffer(video);
+}
+
+void V_PanCamera(video_t* video, int dx, int dy)
+{
+    video->camera.follow = false;
+    video->camera.x += dx;
+    video->camera.y += dy;
+    ApplyCamera(video);
+}
+
+void V_FollowPiece(video_t* video)
+{
+    video->camera.follow = true;
+}
+
+void V_DrawLevel(video_t* video, int level)
+{
+    static char strBuf[24];
+    snprintf(strBuf, sizeof strBuf, "Score: %d", level);
+
+    DrawText(video, video->layout.sideTextX, video->layout.scoreY, strBuf);
+
+    int stageCalc = level / 10;
+    if (stageCalc > 25)
+        stageCalc = 25;
+    const char stage = 'A' + stageCalc;
+    snprintf(strBuf, sizeof strBuf, "Level: %c", stage);
+
+    DrawText(video, video->layout.sideTextX, video->layout.levelY, strBuf);
+}
+
+void V_DrawFinesse(video_t* video, int faults)
+{
+    static char strBuf[24];
+    snprintf(strBuf, sizeof strBuf, "Finesse: %d", faults);
+
+    DrawText(video, video->layout.sideTextX, video->layout.finesseY, strBuf);
+}
+
+void V_DrawFailure(video_t* video, int level)
+{
+    static char strBuf[24];
+    snprintf(strBuf, sizeof strBuf, "Final Score: %d", level);
+
+    DrawText(video, video->layout.failX, video->layout.failY, strBuf);
+}
+
+void V_DrawPaused(video_t* video)
+{
+    DrawText(video, video->layout.failX, video->layout.failY, "Paused");
+}
+
+// the framebuffer renderer is there for when rendering is on the cpu
+// anyway, then the whole frame is already sitting in the window surface
+// & can be copied from there instead of read back through the renderer
+static void CaptureFrame(video_t* video)
+{
+    if (video->boardRenderer == BOARDRENDERER_FRAMEBUFFER && video->softwareRenderer && !video->scene)
+    {
+        SDL_RenderFlush(video->renderer);
+
+        SDL_Surface* surface = SDL_GetWindowSurface(video->window);
+        if (surface && (surface->format->format == SDL_PIXELFORMAT_ARGB8888 ||
+                        surface->format->format == SDL_PIXELFORMAT_RGB888))
+        {
+            V_CaptureFramePixels(video->capture, surface->pixels, surface->pitch, surface->w, surface->h);
+            return;
+        }
+    }
+
+    V_CaptureFrame(video->capture, video->renderer, video->width, video->height);
+}
+
+void V_Present(video_t* video)
+{
+    FlushBatch(video);
+
+    // still on the scene if there is one
+    if (video->capture)
+    {
+        CaptureFrame(video);
+    }
+
+    if (video->scene)
+    {
+        SDL_SetRenderTarget(video->renderer, NULL);
+        SDL_SetRenderDrawColor(video->renderer, 0, 0, 0, 255);
+        SDL_RenderClear(video->renderer);
+        SDL_RenderCopy(video->renderer, video->scene, NULL, &video->sceneRect);
+    }
+
+    V_PacerPresent(video->pacer, video->renderer);
+
+    if (video->scene)
+    {
+        SDL_SetRenderTarget(video->renderer, video->scene);
+    }
+}
+
+void V_GetTextStats(video_t* video, textcachestats_t* stats)
+{
+    V_GetTextCacheStats(video->textCache, stats);
+}
+
+void V_Quit(video_t* video)
+{
+    // it has to finish before the font can go
+    if (video->loader)
+        SDL_WaitThread(video->loader, NULL);
+    if (video->loadedAtlas)
+        SDL_FreeSurface(video->loadedAtlas);
+
+    if (video->textCache)
+        V_DestroyTextCache(video->textCache);
+
+    DestroyBoardCache(video);
+    DestroyBoardFramebuffer(video);
+
+    if (video->minimap)
+        SDL_DestroyTexture(video->minimap);
+
+    if (video->tileAtlas)
+        SDL_DestroyTexture(video->tileAtlas);
+
+    if (video->tilePixels)
+        S_Free(video->alloc, video->tilePixels);
+
+    if (video->scene)
+        SDL_DestroyTexture(video->scene);
+
+    S_Free(video->alloc, video->batchIndices);
+    S_Free(video->alloc, video->batchVertices);
+
+    if (video->glyphAtlas)
+        SDL_DestroyTexture(video->glyphAtlas);
+
+    if (video->textIndices)
+        S_Free(video->alloc, video->textIndices);
+    if (video->textVertices)
+        S_Free(video->alloc, video->textVertices);
+
+#if defined(BLOCKGAM_USE_TTF)
+    for (int i = 0; i < FONT_SIZES; i++)
+    {
+        if (video->fontSizes[i].font)
+            TTF_CloseFont(video->fontSizes[i].font);
+    }
+
+#if defined(__unix__)
+    if (video->fontData)
+        munmap(video->fontData, video->fontDataSize);
+#endif
+#endif
+
+    if (video->pacer)
+        V_DestroyPacer(video->pacer);
+
+    if (video->capture)
+        V_DestroyCapture(video->capture);
+
+    if (video->particles)
+        V_DestroyParticles(video->particles);
+
+#if defined(BLOCKGAM_USE_TTF)
+    if (video->fontTried)
+        TTF_Quit();
+#endif
+
+    SDL_DestroyRenderer(video->renderer);
+
+    SDL_DestroyWindow(video->window);
+
+    SDL_QuitSubSystem(SDL_INIT_VIDEO);
+
+    S_Free(video->alloc, video);
+}
+
+void V_WindowResized(video_t* video, int w, int h)
+{
+    video->windowWidth = w;
+    video->windowHeight = h;
+
+    if (video->scene)
+    {
+        // the scene stays the same size, it just gets scaled differently
+        FitScene(video);
+        return;
+    }
+
+    // until it settles, everything's drawn at the old size & stretched
+    if (!video->resizePending)
+    {
+        SDL_RenderSetLogicalSize(video->renderer, video->width, video->height);
+    }
+
+    video->resizePending = true;
+    video->resizeTime = SDL_GetTicks64();
+}
+
+int V_SettleResize(video_t* video)
+{
+    if (!video->resizePending)
+    {
+        return -1;
+    }
+
+    const uint64_t waited = SDL_GetTicks64() - video->resizeTime;
+    if (waited < RESIZE_SETTLE_MS)
+    {
+        return (int)(RESIZE_SETTLE_MS - waited);
+    }
+
+    video->resizePending = false;
+    SDL_RenderSetLogicalSize(video->renderer, 0, 0);
+
+    video->width = video->windowWidth;
+    video->height = video->windowHeight;
+
+    CalculateLayout(video);
+
+    // old sizes in the text cache just age out, the loader might still
+    // have the font though, so it has to wait
+    if (video->loading)
+    {
+        video->loadedSizeStale = true;
+    }
+    else
+    {
+        SetFontSize(video);
+        BuildGlyphAtlas(video);
+    }
+
+    BuildTileAtlas(video);
+    DestroyBoardCache(video);
+    DestroyBoardFramebuffer(video);
+
+    return -1;
+}
+
+void V_RenderTargetsReset(video_t* video)
+{
+    // whatever was drawn into the cache is gone
+    video->boardCacheValid = false;
 }
@@ -25,30 +25,86 @@ struct menu_s;
 struct board_s;
 struct piece_s;
 struct alloc_s;
+struct textcachestats_s;
 
 typedef struct video_s video_t;
 
 video_t* V_Init(struct alloc_s* alloc, int width, int height);
 
+// the window shows up straight away & text gets ready on another thread,
+// call this every frame until it's true, nothing draws text before then
+bool V_FinishLoading(video_t* video);
+
+// something to look at until V_FinishLoading is true
+void V_DrawLoading(video_t* video);
+
 // r g b is colour of background
 void V_Clear(video_t* video, int r, int g, int b);
 
 void V_SetVisibility(video_t* video, bool visible);
 
+bool V_IsVisible(video_t* video);
+
 void V_DrawMenu(video_t* video, struct menu_s* menu);
 
 void V_DrawBoard(video_t* video, struct board_s* board);
 
-void V_DrawPiece(video_t* video, struct piece_s* piece);
+// fall is how far above its spaces to draw the piece, in spaces, so it
+// can move smoothly in between ticks, below them when it's negative
+void V_DrawPiece(video_t* video, struct piece_s* piece, float fall);
+
+// more than one board get drawn side by side with V_DrawBoardSlot instead
+// of V_DrawBoard & V_DrawPiece, with the camera turned off
+void V_SetBoardCount(video_t* video, int count);
+
+// draws the board in one of the wall's slots, & its piece if it's not NULL
+// failed boards get greyed out
+void V_DrawBoardSlot(video_t* video, int slot, struct board_s* board, struct piece_s* piece, float fall, bool failed);
+
+// blocks of a cleared row flying apart, cells is the row, GRID_WIDTH long,
+// from before it got cleared, slot is which board it was on
+void V_BurstRow(video_t* video, int slot, int y, const uint8_t* cells);
+
+// dust kicked up under a block that just landed in space x, y
+void V_LandingDust(video_t* video, int slot, int x, int y);
+
+// moves the bursts & dust along & draws them over the board
+void V_DrawEffects(video_t* video);
+
+// the camera is all the way out to start with, showing the whole board
+// while zoomed in it follows the piece, unless it gets panned somewhere
+void V_AimCamera(video_t* video, struct piece_s* piece);
+
+void V_ZoomCamera(video_t* video, int steps);
+
+// in board spaces, y going up
+void V_PanCamera(video_t* video, int dx, int dy);
+
+void V_FollowPiece(video_t* video);
 
 void V_DrawLevel(video_t* video, int level);
 
+void V_DrawFinesse(video_t* video, int faults);
+
 void V_DrawFailure(video_t* video, int level);
 
+void V_DrawPaused(video_t* video);
+
 void V_Present(video_t* video);
 
+// hits, misses & so on for strings drawn without the glyph atlas
+void V_GetTextStats(video_t* video, struct textcachestats_s* stats);
+
 void V_Quit(video_t* video);
 
+// waits for the size to stop changing, what's drawn gets stretched to the
+// new size until V_SettleResize catches up
 void V_WindowResized(video_t* video, int w, int h);
 
+// call every frame, redoes everything for the new size once it's settled
+// returns how many ms until that's due, or -1 if nothing's waiting
+int V_SettleResize(video_t* video);
+
+void V_RenderTargetsReset(video_t* video);
+
 #endif  // TEBRIS_V_VIDEO_H